@@ -0,0 +1,330 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <poll.h>
+#include <dlfcn.h>
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+#include "../src/Package/PackageService.h"
+#include "../src/Package/PackagePaths.h"
+#include "../src/Event/EventHandler.h"
+#include "../src/Event/EventContainer.h"
+#include "../src/Event/EventPool.h"
+#include "../src/AllocationCounter.h"
+
+// Pre-defined
+#ifndef MRH_USERVICE_BENCH_PACKAGE_PATH
+    #define MRH_USERVICE_BENCH_PACKAGE_PATH "./bench/Package/"
+#endif
+
+namespace
+{
+    // Measured combinations
+    const MRH_Uint32 p_DataSize[] = { 0, 64, 512, 4096 };
+    const MRH_Uint32 p_EventLimit[] = { 1, 16, 64, 256 };
+    
+    // Events per measurement, rounds are limited by the event limit
+    constexpr size_t us_EventTotal = 200000;
+    constexpr size_t us_WarmupRounds = 100;
+    
+    struct Result
+    {
+        double f64_EventsPerS;
+        double f64_P50NS;
+        double f64_P99NS;
+        double f64_AllocsPerEvent;
+    };
+}
+
+//*************************************************************************************
+// Event Container
+//*************************************************************************************
+
+class BenchEventContainer : public EventContainer
+{
+public:
+
+    /**
+     *  Default constructor.
+     *
+     *  \param us_ReserveStep The amount of extra space to reserve on reallocation.
+     */
+    
+    BenchEventContainer(size_t us_ReserveStep) noexcept : EventContainer(us_ReserveStep)
+    {}
+    
+    using EventContainer::AddEvents;
+};
+
+//*************************************************************************************
+// Measurement
+//*************************************************************************************
+
+namespace
+{
+    MRH_Uint64 GetTimeNS() noexcept
+    {
+        struct timespec c_Time;
+        clock_gettime(CLOCK_MONOTONIC, &c_Time);
+        
+        return static_cast<MRH_Uint64>(c_Time.tv_sec) * 1000000000ULL + static_cast<MRH_Uint64>(c_Time.tv_nsec);
+    }
+    
+    template<typename Round>
+    Result Measure(size_t us_RoundEvents, Round RunRound)
+    {
+        size_t us_Rounds = us_EventTotal / us_RoundEvents;
+        std::vector<double> v_Sample;
+        
+        v_Sample.reserve(us_Rounds);
+        
+        for (size_t i = 0; i < us_WarmupRounds; ++i)
+        {
+            RunRound();
+        }
+        
+        size_t us_Events = 0;
+        MRH_Uint64 u64_AllocStart = AllocationCounter::GetThreadCount().u64_Allocations;
+        MRH_Uint64 u64_Start = GetTimeNS();
+        
+        for (size_t i = 0; i < us_Rounds; ++i)
+        {
+            MRH_Uint64 u64_RoundStart = GetTimeNS();
+            size_t us_Count = RunRound();
+            MRH_Uint64 u64_RoundEnd = GetTimeNS();
+            
+            if (us_Count > 0)
+            {
+                // Per event cost of this round
+                v_Sample.emplace_back(static_cast<double>(u64_RoundEnd - u64_RoundStart) / us_Count);
+                us_Events += us_Count;
+            }
+        }
+        
+        MRH_Uint64 u64_End = GetTimeNS();
+        MRH_Uint64 u64_AllocEnd = AllocationCounter::GetThreadCount().u64_Allocations;
+        
+        Result c_Result = { 0, 0, 0, 0 };
+        
+        if (us_Events == 0 || v_Sample.size() == 0)
+        {
+            return c_Result;
+        }
+        
+        std::sort(v_Sample.begin(), v_Sample.end());
+        
+        // Sample vector allocations are done up front
+        c_Result.f64_EventsPerS = us_Events / (static_cast<double>(u64_End - u64_Start) / 1000000000.0);
+        c_Result.f64_P50NS = v_Sample[v_Sample.size() / 2];
+        c_Result.f64_P99NS = v_Sample[(v_Sample.size() * 99) / 100];
+        c_Result.f64_AllocsPerEvent = static_cast<double>(u64_AllocEnd - u64_AllocStart) / us_Events;
+        
+        return c_Result;
+    }
+    
+    void PrintResult(const char* p_Stage, MRH_Uint32 u32_EventLimit, MRH_Uint32 u32_DataSize, Result const& c_Result) noexcept
+    {
+        std::printf("%-16s %8u %8u %14.0f %10.1f %10.1f %12.3f\n",
+                    p_Stage,
+                    u32_EventLimit,
+                    u32_DataSize,
+                    c_Result.f64_EventsPerS,
+                    c_Result.f64_P50NS,
+                    c_Result.f64_P99NS,
+                    c_Result.f64_AllocsPerEvent);
+    }
+    
+    //*************************************************************************************
+    // Pipe Reader
+    //*************************************************************************************
+    
+    void ReadPipe(int i_FD, std::atomic<bool>* p_Run) noexcept
+    {
+        static char p_Buffer[65536];
+        struct pollfd c_Read;
+        
+        c_Read.fd = i_FD;
+        c_Read.events = POLLIN;
+        
+        // Discard everything, libmrhev might keep the write end open
+        while (*p_Run == true)
+        {
+            if (poll(&c_Read, 1, 100) > 0 && read(i_FD, p_Buffer, sizeof(p_Buffer)) <= 0)
+            {
+                break;
+            }
+        }
+    }
+}
+
+//*************************************************************************************
+// Main
+//*************************************************************************************
+
+int main(int argc, const char* argv[])
+{
+    // Package with the mock service
+    const char* p_PackagePath = argc > 1 ? argv[1] : MRH_USERVICE_BENCH_PACKAGE_PATH;
+    
+    std::printf("Package: %s\n\n", p_PackagePath);
+    std::printf("%-16s %8s %8s %14s %10s %10s %12s\n",
+                "Stage", "Limit", "Payload", "Events/s", "p50 ns", "p99 ns", "Allocs/event");
+    
+    for (MRH_Uint32 u32_EventLimit : p_EventLimit)
+    {
+        std::string s_EventLimit(std::to_string(u32_EventLimit));
+        
+        PackageService* p_Service;
+        EventHandler* p_EventHandler;
+        void (*BenchConfigure)(MRH_Uint32, MRH_Uint32);
+        
+        int p_Pipe[2];
+        std::atomic<bool> b_ReaderRun(true);
+        
+        if (pipe(p_Pipe) < 0)
+        {
+            std::printf("Failed to create pipe: %s\n", std::strerror(errno));
+            return EXIT_FAILURE;
+        }
+        
+        std::thread c_Reader(ReadPipe, p_Pipe[0], &b_ReaderRun);
+        
+        try
+        {
+            p_Service = new PackageService(p_PackagePath, s_EventLimit.c_str());
+            // The event handler owns its write end
+            p_EventHandler = new EventHandler(EventTransport::TRANSPORT_PIPE, std::to_string(dup(p_Pipe[1])).c_str(), s_EventLimit.c_str());
+            
+            p_Service->LoadSharedObject();
+            
+            // Like mrhuservice, the pipe transport does not pool events
+            if (EventPool::Singleton().GetEnabled() == true)
+            {
+                p_Service->SetEventPool(EventPool::AcquireEvent, EventPool::ReleaseEvent);
+            }
+            
+            p_Service->Init();
+            
+            // Same object, already loaded by the service
+            std::string s_SharedObjectPath(p_PackagePath);
+            
+            if (*(s_SharedObjectPath.end() - 1) != '/')
+            {
+                s_SharedObjectPath += "/";
+            }
+            
+            void* p_Handle = dlopen((s_SharedObjectPath + PACKAGE_SERVICE_BINARY_PATH).c_str(), RTLD_NOW | RTLD_NOLOAD);
+            
+            if (p_Handle == NULL || (BenchConfigure = reinterpret_cast<void(*)(MRH_Uint32, MRH_Uint32)>(dlsym(p_Handle, "MRH_BenchConfigure"))) == NULL)
+            {
+                throw Exception("Failed to find MRH_BenchConfigure in the mock service!");
+            }
+            
+            dlclose(p_Handle);
+        }
+        catch (Exception& e)
+        {
+            std::printf("Failed to setup benchmark: %s\n", e.what());
+            
+            b_ReaderRun = false;
+            close(p_Pipe[1]);
+            c_Reader.join();
+            close(p_Pipe[0]);
+            
+            return EXIT_FAILURE;
+        }
+        
+        for (MRH_Uint32 u32_DataSize : p_DataSize)
+        {
+            BenchConfigure(u32_DataSize, u32_EventLimit);
+            
+            // Container only, the same events are moved in and out
+            BenchEventContainer c_Container(u32_EventLimit);
+            std::vector<MRH_Event*> v_Event(u32_EventLimit, NULL);
+            std::vector<MRH_Event*> v_Moved(u32_EventLimit, NULL);
+            
+            for (auto& Event : v_Event)
+            {
+                Event = EventPool::AcquireEvent(1, u32_DataSize);
+            }
+            
+            PrintResult("EventContainer", u32_EventLimit, u32_DataSize, Measure(u32_EventLimit, [&]()
+            {
+                c_Container.AddEvents(v_Event.data(), v_Event.size());
+                size_t us_Count = c_Container.GetEvents(v_Moved.data(), v_Moved.size());
+                
+                v_Event.swap(v_Moved);
+                return us_Count;
+            }));
+            
+            for (auto& Event : v_Event)
+            {
+                EventPool::Singleton().Release(Event);
+            }
+            
+            // Service recieve, events are released like dropped events
+            PrintResult("RecieveEvents", u32_EventLimit, u32_DataSize, Measure(u32_EventLimit, [&]()
+            {
+                PackageService::ServiceEventContainer* p_Container = p_Service->RecieveEvents();
+                size_t us_Count = p_Container->GetEvents(v_Moved.data(), v_Moved.size());
+                
+                for (size_t i = 0; i < us_Count; ++i)
+                {
+                    EventPool::Singleton().Release(v_Moved[i]);
+                }
+                
+                return us_Count;
+            }));
+            
+            // Full path, recieve and write to the pipe
+            PrintResult("SendEvents", u32_EventLimit, u32_DataSize, Measure(u32_EventLimit, [&]()
+            {
+                PackageService::ServiceEventContainer* p_Container = p_Service->RecieveEvents();
+                size_t us_Count = p_Container->GetEventCount();
+                
+                p_EventHandler->SendEvents(p_Container);
+                return us_Count;
+            }));
+        }
+        
+        p_Service->Exit();
+        p_EventHandler->Exit();
+        
+        delete p_EventHandler;
+        delete p_Service;
+        
+        b_ReaderRun = false;
+        close(p_Pipe[1]);
+        c_Reader.join();
+        close(p_Pipe[0]);
+    }
+    
+    return EXIT_SUCCESS;
+}
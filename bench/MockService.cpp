@@ -0,0 +1,146 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <stdlib.h>
+#include <cstring>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+
+// Pre-defined
+namespace
+{
+    // Benchmark settings, changed by the benchmark between runs
+    MRH_Uint32 u32_DataSize = 0;
+    MRH_Uint32 u32_EventCount = 1;
+    
+    // Event type used for all events
+    constexpr MRH_Uint32 u32_EventType = 1;
+    
+    // Event pool, malloc() if not set
+    MRH_Event* (*EventAcquire)(MRH_Uint32, MRH_Uint32) = NULL;
+    void (*EventRelease)(MRH_Event*) = NULL;
+    
+    MRH_Event* CreateEvent() noexcept
+    {
+        if (EventAcquire != NULL)
+        {
+            return EventAcquire(u32_EventType, u32_DataSize);
+        }
+        
+        MRH_Event* p_Event = static_cast<MRH_Event*>(malloc(sizeof(MRH_Event)));
+        
+        if (p_Event == NULL)
+        {
+            return NULL;
+        }
+        
+        std::memset(p_Event, 0, sizeof(MRH_Event));
+        p_Event->u32_Type = u32_EventType;
+        
+        if (u32_DataSize > 0)
+        {
+            if ((p_Event->p_Data = static_cast<MRH_Uint8*>(malloc(u32_DataSize))) == NULL)
+            {
+                free(p_Event);
+                return NULL;
+            }
+            
+            p_Event->u32_DataSize = u32_DataSize;
+        }
+        
+        return p_Event;
+    }
+}
+
+//*************************************************************************************
+// Mock Application Service
+//*************************************************************************************
+
+// Prevent name wrangling
+extern "C"
+{
+    //*************************************************************************************
+    // Benchmark
+    //*************************************************************************************
+    
+    /**
+     *  Set the events created for each update.
+     *
+     *  \param u32_BenchDataSize The event data size in bytes.
+     *  \param u32_BenchEventCount The amount of events per update.
+     */
+    
+    void MRH_BenchConfigure(MRH_Uint32 u32_BenchDataSize, MRH_Uint32 u32_BenchEventCount)
+    {
+        u32_DataSize = u32_BenchDataSize;
+        u32_EventCount = u32_BenchEventCount;
+    }
+    
+    //*************************************************************************************
+    // Service
+    //*************************************************************************************
+    
+    int MRH_Init(void)
+    {
+        return 0;
+    }
+    
+    int MRH_Update(void)
+    {
+        return 0;
+    }
+    
+    MRH_Event* MRH_SendEvent(void)
+    {
+        // Unlimited, the parent applies the event limit
+        MRH_Event* p_Event = CreateEvent();
+        
+        if (p_Event != NULL && u32_DataSize > 0)
+        {
+            std::memset(p_Event->p_Data, 0xAB, u32_DataSize);
+        }
+        
+        return p_Event;
+    }
+    
+    MRH_Uint32 MRH_SendEventBatch(MRH_Event** p_Event, MRH_Uint32 u32_Max)
+    {
+        MRH_Uint32 u32_Count = u32_Max < u32_EventCount ? u32_Max : u32_EventCount;
+        
+        for (MRH_Uint32 i = 0; i < u32_Count; ++i)
+        {
+            if ((p_Event[i] = MRH_SendEvent()) == NULL)
+            {
+                return i;
+            }
+        }
+        
+        return u32_Count;
+    }
+    
+    void MRH_SetEventPool(MRH_Event* (*p_Acquire)(MRH_Uint32, MRH_Uint32), void (*p_Release)(MRH_Event*))
+    {
+        EventAcquire = p_Acquire;
+        EventRelease = p_Release;
+    }
+    
+    void MRH_Exit(void)
+    {}
+}
@@ -0,0 +1,268 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <dlfcn.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+
+// External
+
+// Project
+#include "./AllocationCounter.h"
+
+// Pre-defined
+#ifndef MRH_USERVICE_PROFILE_MALLOC
+    #define MRH_USERVICE_PROFILE_MALLOC 0
+#endif
+
+namespace
+{
+    // Allocations of the owning thread
+    thread_local AllocationCounter::Count c_ThreadCount = { 0, 0, 0 };
+}
+
+//*************************************************************************************
+// Allocator
+//*************************************************************************************
+
+#if MRH_USERVICE_PROFILE_MALLOC > 0
+namespace
+{
+    // Next definitions, resolved on first use
+    struct Allocator
+    {
+        void* (*Malloc)(size_t);
+        void* (*Calloc)(size_t, size_t);
+        void* (*Realloc)(void*, size_t);
+        void (*Free)(void*);
+        void* (*Memalign)(size_t, size_t);
+        int (*PosixMemalign)(void**, size_t, size_t);
+        void* (*AlignedAlloc)(size_t, size_t);
+        void* (*Valloc)(size_t);
+        void* (*Pvalloc)(size_t);
+    };
+    
+    Allocator c_Next;
+    std::atomic<bool> b_Resolved(false);
+    thread_local bool b_Resolving = false;
+    
+    // dlsym() allocates while resolving, served from here and never freed
+    alignas(std::max_align_t) char p_Bootstrap[4096];
+    std::atomic<size_t> us_BootstrapUsed(0);
+    
+    void* BootstrapAlloc(size_t us_Size) noexcept
+    {
+        us_Size = (us_Size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        size_t us_Offset = us_BootstrapUsed.fetch_add(us_Size, std::memory_order_relaxed);
+        
+        if (us_Offset + us_Size > sizeof(p_Bootstrap))
+        {
+            return NULL;
+        }
+        
+        return p_Bootstrap + us_Offset;
+    }
+    
+    bool GetBootstrap(void* p_Memory) noexcept
+    {
+        return p_Memory >= static_cast<void*>(p_Bootstrap) && p_Memory < static_cast<void*>(p_Bootstrap + sizeof(p_Bootstrap));
+    }
+    
+    bool Resolve() noexcept
+    {
+        if (b_Resolved.load(std::memory_order_acquire) == true)
+        {
+            return true;
+        }
+        else if (b_Resolving == true)
+        {
+            return false;
+        }
+        
+        // Threads resolving at the same time write the same values
+        b_Resolving = true;
+        
+        c_Next.Malloc = reinterpret_cast<void*(*)(size_t)>(dlsym(RTLD_NEXT, "malloc"));
+        c_Next.Calloc = reinterpret_cast<void*(*)(size_t, size_t)>(dlsym(RTLD_NEXT, "calloc"));
+        c_Next.Realloc = reinterpret_cast<void*(*)(void*, size_t)>(dlsym(RTLD_NEXT, "realloc"));
+        c_Next.Free = reinterpret_cast<void(*)(void*)>(dlsym(RTLD_NEXT, "free"));
+        c_Next.Memalign = reinterpret_cast<void*(*)(size_t, size_t)>(dlsym(RTLD_NEXT, "memalign"));
+        c_Next.PosixMemalign = reinterpret_cast<int(*)(void**, size_t, size_t)>(dlsym(RTLD_NEXT, "posix_memalign"));
+        c_Next.AlignedAlloc = reinterpret_cast<void*(*)(size_t, size_t)>(dlsym(RTLD_NEXT, "aligned_alloc"));
+        c_Next.Valloc = reinterpret_cast<void*(*)(size_t)>(dlsym(RTLD_NEXT, "valloc"));
+        c_Next.Pvalloc = reinterpret_cast<void*(*)(size_t)>(dlsym(RTLD_NEXT, "pvalloc"));
+        
+        b_Resolving = false;
+        
+        if (c_Next.Malloc == NULL || c_Next.Calloc == NULL || c_Next.Realloc == NULL || c_Next.Free == NULL)
+        {
+            return false;
+        }
+        
+        b_Resolved.store(true, std::memory_order_release);
+        return true;
+    }
+    
+    inline void CountAllocation(size_t us_Size) noexcept
+    {
+        ++(c_ThreadCount.u64_Allocations);
+        c_ThreadCount.u64_AllocatedBytes += us_Size;
+    }
+}
+
+// @NOTE: Defined by the executable, these take precedence over the libc 
+//        functions for the loaded service as well
+extern "C"
+{
+    void* malloc(size_t us_Size) noexcept
+    {
+        if (Resolve() == false)
+        {
+            return BootstrapAlloc(us_Size);
+        }
+        
+        CountAllocation(us_Size);
+        return c_Next.Malloc(us_Size);
+    }
+    
+    void* calloc(size_t us_Count, size_t us_Size) noexcept
+    {
+        if (Resolve() == false)
+        {
+            // Static memory is zeroed
+            return us_Size == 0 || us_Count <= static_cast<size_t>(-1) / us_Size ? BootstrapAlloc(us_Count * us_Size) : NULL;
+        }
+        
+        CountAllocation(us_Count * us_Size);
+        return c_Next.Calloc(us_Count, us_Size);
+    }
+    
+    void* realloc(void* p_Memory, size_t us_Size) noexcept
+    {
+        if (Resolve() == false)
+        {
+            return NULL;
+        }
+        else if (GetBootstrap(p_Memory) == true)
+        {
+            // Copy out of the static memory, the old size is unknown
+            void* p_Moved = malloc(us_Size);
+            size_t us_Left = static_cast<size_t>(p_Bootstrap + sizeof(p_Bootstrap) - static_cast<char*>(p_Memory));
+            
+            if (p_Moved != NULL)
+            {
+                std::memcpy(p_Moved, p_Memory, us_Size < us_Left ? us_Size : us_Left);
+            }
+            
+            return p_Moved;
+        }
+        
+        // Counted as a new allocation, the block might move
+        CountAllocation(us_Size);
+        return c_Next.Realloc(p_Memory, us_Size);
+    }
+    
+    void free(void* p_Memory) noexcept
+    {
+        if (p_Memory == NULL || GetBootstrap(p_Memory) == true || Resolve() == false)
+        {
+            return;
+        }
+        
+        ++(c_ThreadCount.u64_Frees);
+        c_Next.Free(p_Memory);
+    }
+    
+    void* memalign(size_t us_Alignment, size_t us_Size) noexcept
+    {
+        if (Resolve() == false || c_Next.Memalign == NULL)
+        {
+            return NULL;
+        }
+        
+        CountAllocation(us_Size);
+        return c_Next.Memalign(us_Alignment, us_Size);
+    }
+    
+    int posix_memalign(void** p_Memory, size_t us_Alignment, size_t us_Size) noexcept
+    {
+        if (Resolve() == false || c_Next.PosixMemalign == NULL)
+        {
+            return ENOMEM;
+        }
+        
+        int i_Result = c_Next.PosixMemalign(p_Memory, us_Alignment, us_Size);
+        
+        if (i_Result == 0)
+        {
+            CountAllocation(us_Size);
+        }
+        
+        return i_Result;
+    }
+    
+    void* aligned_alloc(size_t us_Alignment, size_t us_Size) noexcept
+    {
+        if (Resolve() == false || c_Next.AlignedAlloc == NULL)
+        {
+            return NULL;
+        }
+        
+        CountAllocation(us_Size);
+        return c_Next.AlignedAlloc(us_Alignment, us_Size);
+    }
+    
+    void* valloc(size_t us_Size) noexcept
+    {
+        if (Resolve() == false || c_Next.Valloc == NULL)
+        {
+            return NULL;
+        }
+        
+        CountAllocation(us_Size);
+        return c_Next.Valloc(us_Size);
+    }
+    
+    void* pvalloc(size_t us_Size) noexcept
+    {
+        if (Resolve() == false || c_Next.Pvalloc == NULL)
+        {
+            return NULL;
+        }
+        
+        CountAllocation(us_Size);
+        return c_Next.Pvalloc(us_Size);
+    }
+}
+#endif
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool AllocationCounter::GetEnabled() noexcept
+{
+    return MRH_USERVICE_PROFILE_MALLOC > 0;
+}
+
+AllocationCounter::Count AllocationCounter::GetThreadCount() noexcept
+{
+    return c_ThreadCount;
+}
@@ -0,0 +1,81 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef AllocationCounter_h
+#define AllocationCounter_h
+
+// C / C++
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+
+class AllocationCounter
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct Count
+    {
+        MRH_Uint64 u64_Allocations;
+        MRH_Uint64 u64_AllocatedBytes;
+        MRH_Uint64 u64_Frees;
+    };
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Check if the allocation functions are replaced to count allocations.
+     *
+     *  \return true if counted, false if not.
+     */
+    
+    static bool GetEnabled() noexcept;
+    
+    /**
+     *  Get the allocations of the calling thread. All values stay 0 if 
+     *  allocations are not counted.
+     *
+     *  \return The allocations of the calling thread.
+     */
+    
+    static Count GetThreadCount() noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. Disabled for this class.
+     */
+    
+    AllocationCounter() = delete;
+
+protected:
+
+};
+
+#endif /* AllocationCounter_h */
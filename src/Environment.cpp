@@ -25,6 +25,7 @@
 
 // Project
 #include "./Environment.h"
+#include "./Package/ConfigurationCache.h"
 #include "./Package/PackagePaths.h"
 #include "./Logger.h"
 
@@ -166,8 +167,7 @@ void Environment::UpdateCurrentDir()
         throw Exception("Failed to change current directory: " + std::string(std::strerror(errno)) + " (" + std::to_string(errno) + ")!");
     }
     
-    Logger::Singleton().Log(Logger::INFO, "Current working dir set to: " + s_WorkingDir,
-                            "Environment.cpp", __LINE__);
+    MRH_LOG_INFO("Current working dir set to: ", s_WorkingDir);
 }
 
 //*************************************************************************************
@@ -176,11 +176,24 @@ void Environment::UpdateCurrentDir()
 
 void Environment::LoadSystemLocale()
 {
-    Logger& c_Logger = Logger::Singleton();
-    c_Logger.Log(Logger::INFO, "Reading locale file " +
-                               std::string(MRH_LOCALE_FILE_PATH) +
-                               "...",
-                 "Environment.cpp", __LINE__);
+    // Unchanged locale files are read from the package cache
+    ConfigurationCache c_Cache(s_PackagePath);
+    std::string s_CachedLocale;
+    
+    if (c_Cache.GetLocale(MRH_LOCALE_FILE_PATH, s_CachedLocale) == true)
+    {
+        std::setlocale(LC_ALL, s_CachedLocale.c_str());
+        
+        if (s_CachedLocale.compare(std::setlocale(LC_ALL, NULL)) == 0)
+        {
+            s_Locale = s_CachedLocale;
+            
+            MRH_LOG_INFO("Locale set to ", s_Locale, " (cached).");
+            return;
+        }
+    }
+    
+    MRH_LOG_INFO("Reading locale file ", MRH_LOCALE_FILE_PATH, "...");
     
     try
     {
@@ -201,15 +214,15 @@ void Environment::LoadSystemLocale()
                 throw Exception("Failed to update locale!");
             }
             
-            c_Logger.Log(Logger::INFO, "Locale set to " + s_Locale + ".",
-                         "Environment.cpp", __LINE__);
+            MRH_LOG_INFO("Locale set to ", s_Locale, ".");
+            
+            c_Cache.SetLocale(s_Locale);
             break;
         }
     }
     catch (std::exception& e) // + MRH_BFException
     {
-        c_Logger.Log(Logger::WARNING, std::string(e.what()) + ", using default locale.",
-                     "Environment.cpp", __LINE__);
+        MRH_LOG_WARNING(e.what(), ", using default locale.");
         std::setlocale(LC_ALL, p_DefaultLocale);
     }
 }
@@ -15,58 +15,280 @@
  */
 
 // C / C++
-#include <stdlib.h>
+#include <cstring>
 
 // External
 
 // Project
 #include "./EventContainer.h"
+#include "./EventPool.h"
+#include "../Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Events taken from higher lanes before a waiting lower lane is taken from
+    constexpr size_t us_MaxSkipped = 32;
+    
+    static_assert(EventContainer::PRIORITY_COUNT == Metrics::HISTOGRAM_LANE_LOW_US - Metrics::HISTOGRAM_LANE_HIGH_US + 1, "Missing lane metrics!");
+}
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-EventContainer::EventContainer(size_t us_ReserveStep) noexcept
+EventContainer::EventContainer(size_t us_ReserveStep) noexcept : us_Count(0),
+                                                                 b_Latency(false),
+                                                                 us_MetricsService(Metrics::us_ServiceCount)
 {
     if ((this->us_ReserveStep = us_ReserveStep) == 0)
     {
         this->us_ReserveStep = 1;
     }
     
-    v_Event.reserve(this->us_ReserveStep);
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        p_Lane[i].us_Head = 0;
+        p_Lane[i].us_Count = 0;
+        p_Lane[i].us_Skipped = 0;
+    }
+    
+    // Other lanes grow on first use, most events are not prioritized
+    p_Lane[PRIORITY_NORMAL].v_Event.resize(this->us_ReserveStep, NULL);
+    p_Lane[PRIORITY_NORMAL].v_TimeNS.resize(this->us_ReserveStep, 0);
 }
 
 EventContainer::~EventContainer() noexcept
 {
-    for (auto& Event : v_Event)
+    MRH_Event* p_Event;
+    
+    while ((p_Event = GetEvent()) != NULL)
+    {
+        EventPool::Singleton().Release(p_Event);
+    }
+}
+
+//*************************************************************************************
+// Priority
+//*************************************************************************************
+
+void EventContainer::SetPriority(MRH_Uint32 u32_Type, Priority e_Priority)
+{
+    for (auto& Type : v_Priority)
     {
-        if (Event->p_Data != NULL)
+        if (Type.u32_Type == u32_Type)
         {
-            free(Event->p_Data);
+            Type.e_Priority = e_Priority;
+            return;
         }
-        
-        free(Event);
     }
+    
+    v_Priority.push_back({ u32_Type, e_Priority });
+}
+
+void EventContainer::SetPriority(EventContainer const& c_EventContainer)
+{
+    v_Priority = c_EventContainer.v_Priority;
+}
+
+void EventContainer::SetLatency(bool b_Latency) noexcept
+{
+    this->b_Latency = b_Latency;
+}
+
+void EventContainer::RecordLatency(Priority e_Priority, MRH_Uint64 u64_TimeNS) noexcept
+{
+    // Events added without latency recording have no added time
+    if (u64_TimeNS > 0)
+    {
+        Metrics::Singleton().Record(static_cast<Metrics::Histogram>(Metrics::HISTOGRAM_LANE_HIGH_US + e_Priority),
+                                    (Metrics::GetTimeNS() - u64_TimeNS) / 1000);
+    }
+}
+
+//*************************************************************************************
+// Metrics
+//*************************************************************************************
+
+void EventContainer::SetMetricsService(size_t us_Service) noexcept
+{
+    us_MetricsService = us_Service;
+}
+
+//*************************************************************************************
+// Reserve
+//*************************************************************************************
+
+void EventContainer::Reserve(Lane& c_Lane)
+{
+    // Unwrap the ring into the new buffer, oldest event first
+    size_t us_Size = c_Lane.v_Event.size();
+    std::vector<MRH_Event*> v_Resized(us_Size + us_ReserveStep, NULL);
+    std::vector<MRH_Uint64> v_ResizedTimeNS(us_Size + us_ReserveStep, 0);
+    
+    for (size_t i = 0; i < c_Lane.us_Count; ++i)
+    {
+        v_Resized[i] = c_Lane.v_Event[(c_Lane.us_Head + i) % us_Size];
+        v_ResizedTimeNS[i] = c_Lane.v_TimeNS[(c_Lane.us_Head + i) % us_Size];
+    }
+    
+    c_Lane.v_Event.swap(v_Resized);
+    c_Lane.v_TimeNS.swap(v_ResizedTimeNS);
+    c_Lane.us_Head = 0;
 }
 
 //*************************************************************************************
 // Add
 //*************************************************************************************
 
+void EventContainer::Push(MRH_Event*& p_Event, MRH_Uint64 u64_TimeNS, Priority e_Priority) noexcept
+{
+    Lane& c_Lane = p_Lane[e_Priority];
+    
+    // Reserve more space, the ring is full
+    if (c_Lane.us_Count == c_Lane.v_Event.size())
+    {
+        Reserve(c_Lane);
+    }
+    
+    size_t us_Tail = c_Lane.us_Head + c_Lane.us_Count;
+    
+    if (us_Tail >= c_Lane.v_Event.size())
+    {
+        us_Tail -= c_Lane.v_Event.size();
+    }
+    
+    c_Lane.v_Event[us_Tail] = p_Event;
+    c_Lane.v_TimeNS[us_Tail] = u64_TimeNS;
+    ++(c_Lane.us_Count);
+    ++us_Count;
+    
+    p_Event = NULL;
+}
+
 void EventContainer::AddEvent(MRH_Event*& p_Event) noexcept
 {
     if (p_Event != NULL)
     {
-        // Reserve more space
-        if (v_Event.size() == v_Event.capacity())
+        Push(p_Event, b_Latency == true ? Metrics::GetTimeNS() : 0, GetPriority(p_Event->u32_Type));
+    }
+}
+
+void EventContainer::AddEvent(MRH_Event*& p_Event, MRH_Uint64 u64_TimeNS, Priority e_Priority) noexcept
+{
+    if (p_Event != NULL)
+    {
+        Push(p_Event, u64_TimeNS, e_Priority);
+    }
+}
+
+void EventContainer::AddEvents(MRH_Event** p_Event, size_t us_Count) noexcept
+{
+    if (p_Event == NULL || us_Count == 0)
+    {
+        return;
+    }
+    
+    MRH_Uint64 u64_TimeNS = b_Latency == true ? Metrics::GetTimeNS() : 0;
+    
+    // NULL events are skipped and prioritized events sorted, add one by one
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        if (p_Event[i] == NULL || v_Priority.size() > 0)
         {
-            v_Event.reserve(v_Event.capacity() + us_ReserveStep);
+            for (i = 0; i < us_Count; ++i)
+            {
+                if (p_Event[i] != NULL)
+                {
+                    Push(p_Event[i], u64_TimeNS, GetPriority(p_Event[i]->u32_Type));
+                }
+            }
+            
+            return;
+        }
+    }
+    
+    Lane& c_Lane = p_Lane[PRIORITY_NORMAL];
+    
+    // Reserve more space, the ring is too small
+    while (c_Lane.v_Event.size() - c_Lane.us_Count < us_Count)
+    {
+        Reserve(c_Lane);
+    }
+    
+    // Copy in at most two parts, before and after the ring wraps
+    size_t us_Tail = (c_Lane.us_Head + c_Lane.us_Count) % c_Lane.v_Event.size();
+    size_t us_First = c_Lane.v_Event.size() - us_Tail;
+    
+    if (us_First > us_Count)
+    {
+        us_First = us_Count;
+    }
+    
+    std::memcpy(&(c_Lane.v_Event[us_Tail]), p_Event, us_First * sizeof(MRH_Event*));
+    std::memcpy(&(c_Lane.v_Event[0]), p_Event + us_First, (us_Count - us_First) * sizeof(MRH_Event*));
+    
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        c_Lane.v_TimeNS[(us_Tail + i) % c_Lane.v_TimeNS.size()] = u64_TimeNS;
+    }
+    
+    std::memset(p_Event, 0, us_Count * sizeof(MRH_Event*));
+    c_Lane.us_Count += us_Count;
+    this->us_Count += us_Count;
+}
+
+//*************************************************************************************
+// Lane
+//*************************************************************************************
+
+EventContainer::Priority EventContainer::GetPriority(MRH_Uint32 u32_Type) const noexcept
+{
+    for (auto& Type : v_Priority)
+    {
+        if (Type.u32_Type == u32_Type)
+        {
+            return Type.e_Priority;
+        }
+    }
+    
+    return PRIORITY_NORMAL;
+}
+
+size_t EventContainer::SelectLane() noexcept
+{
+    size_t us_Lane = PRIORITY_COUNT;
+    
+    // Strict priority, unless a lower lane was passed over too often
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i)
+    {
+        if (p_Lane[i].us_Count == 0)
+        {
+            continue;
+        }
+        else if (us_Lane == PRIORITY_COUNT)
+        {
+            us_Lane = i;
+        }
+        else if (p_Lane[i].us_Skipped >= us_MaxSkipped)
+        {
+            us_Lane = i;
+            break;
+        }
+    }
+    
+    p_Lane[us_Lane].us_Skipped = 0;
+    
+    for (size_t i = us_Lane + 1; i < PRIORITY_COUNT; ++i)
+    {
+        if (p_Lane[i].us_Count > 0)
+        {
+            ++(p_Lane[i].us_Skipped);
         }
-        
-        v_Event.emplace_back(p_Event);
-        p_Event = NULL;
     }
+    
+    return us_Lane;
 }
 
 //*************************************************************************************
@@ -75,18 +297,101 @@ void EventContainer::AddEvent(MRH_Event*& p_Event) noexcept
 
 size_t EventContainer::GetEventCount() noexcept
 {
-    return v_Event.size();
+    return us_Count;
+}
+
+size_t EventContainer::GetMetricsService() const noexcept
+{
+    return us_MetricsService;
 }
 
 MRH_Event* EventContainer::GetEvent() noexcept
 {
-    if (v_Event.size() == 0)
+    MRH_Uint64 u64_TimeNS;
+    Priority e_Priority;
+    MRH_Event* p_Event = GetEvent(u64_TimeNS, e_Priority);
+    
+    if (p_Event != NULL)
+    {
+        RecordLatency(e_Priority, u64_TimeNS);
+    }
+    
+    return p_Event;
+}
+
+MRH_Event* EventContainer::GetEvent(MRH_Uint64& u64_TimeNS, Priority& e_Priority) noexcept
+{
+    if (us_Count == 0)
     {
         return NULL;
     }
     
-    MRH_Event* p_Event = v_Event[0];
-    v_Event.erase(v_Event.begin());
+    e_Priority = static_cast<Priority>(SelectLane());
+    Lane& c_Lane = p_Lane[e_Priority];
+    
+    MRH_Event* p_Event = c_Lane.v_Event[c_Lane.us_Head];
+    u64_TimeNS = c_Lane.v_TimeNS[c_Lane.us_Head];
+    
+    if (++(c_Lane.us_Head) == c_Lane.v_Event.size())
+    {
+        c_Lane.us_Head = 0;
+    }
+    
+    --(c_Lane.us_Count);
+    --us_Count;
     
     return p_Event;
 }
+
+size_t EventContainer::GetEvents(MRH_Event** p_Event, size_t us_Count) noexcept
+{
+    if (p_Event == NULL)
+    {
+        return 0;
+    }
+    else if (us_Count > this->us_Count)
+    {
+        us_Count = this->us_Count;
+    }
+    
+    // Lanes have to be interleaved, take one by one
+    if (us_Count == 0 || p_Lane[PRIORITY_NORMAL].us_Count != this->us_Count)
+    {
+        for (size_t i = 0; i < us_Count; ++i)
+        {
+            p_Event[i] = GetEvent();
+        }
+        
+        return us_Count;
+    }
+    
+    Lane& c_Lane = p_Lane[PRIORITY_NORMAL];
+    
+    if (b_Latency == true)
+    {
+        MRH_Uint64 u64_TimeNS = Metrics::GetTimeNS();
+        Metrics& c_Metrics = Metrics::Singleton();
+        
+        for (size_t i = 0; i < us_Count; ++i)
+        {
+            c_Metrics.Record(Metrics::HISTOGRAM_LANE_NORMAL_US, (u64_TimeNS - c_Lane.v_TimeNS[(c_Lane.us_Head + i) % c_Lane.v_TimeNS.size()]) / 1000);
+        }
+    }
+    
+    // Copy in at most two parts, before and after the ring wraps
+    size_t us_First = c_Lane.v_Event.size() - c_Lane.us_Head;
+    
+    if (us_First > us_Count)
+    {
+        us_First = us_Count;
+    }
+    
+    std::memcpy(p_Event, &(c_Lane.v_Event[c_Lane.us_Head]), us_First * sizeof(MRH_Event*));
+    std::memcpy(p_Event + us_First, &(c_Lane.v_Event[0]), (us_Count - us_First) * sizeof(MRH_Event*));
+    
+    c_Lane.us_Head = (c_Lane.us_Head + us_Count) % c_Lane.v_Event.size();
+    c_Lane.us_Count -= us_Count;
+    this->us_Count -= us_Count;
+    
+    return us_Count;
+}
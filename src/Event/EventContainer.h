@@ -18,6 +18,7 @@
 #define EventContainer_h
 
 // C / C++
+#include <cstddef>
 #include <vector>
 
 // External
@@ -30,6 +31,75 @@ class EventContainer
 {
 public:
 
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        PRIORITY_HIGH = 0,
+        PRIORITY_NORMAL = 1,
+        PRIORITY_LOW = 2,
+        
+        PRIORITY_MAX = PRIORITY_LOW,
+        
+        PRIORITY_COUNT = PRIORITY_MAX + 1
+    
+    }Priority;
+    
+    //*************************************************************************************
+    // Priority
+    //*************************************************************************************
+    
+    /**
+     *  Set the lane for a event type. Event types without a lane use the normal 
+     *  priority lane. Only call before events are added.
+     *
+     *  \param u32_Type The event type.
+     *  \param e_Priority The priority lane of the event type.
+     */
+    
+    void SetPriority(MRH_Uint32 u32_Type, Priority e_Priority);
+    
+    /**
+     *  Use the event type lanes of another container. Only call before events 
+     *  are added.
+     *
+     *  \param c_EventContainer The container to copy the lanes from.
+     */
+    
+    void SetPriority(EventContainer const& c_EventContainer);
+    
+    /**
+     *  Set if the time events wait in the container is recorded per lane.
+     *
+     *  \param b_Latency true to record, false to not record.
+     */
+    
+    void SetLatency(bool b_Latency) noexcept;
+    
+    /**
+     *  Record the time a event waited in its lane.
+     *
+     *  \param e_Priority The lane of the event.
+     *  \param u64_TimeNS The time the event was added in nanoseconds, 0 if 
+     *                    the time was not recorded.
+     */
+    
+    static void RecordLatency(Priority e_Priority, MRH_Uint64 u64_TimeNS) noexcept;
+    
+    //*************************************************************************************
+    // Metrics
+    //*************************************************************************************
+    
+    /**
+     *  Set the service gauge set the queue depth of the container is recorded in.
+     *
+     *  \param us_Service The service gauge set.
+     */
+    
+    void SetMetricsService(size_t us_Service) noexcept;
+    
     //*************************************************************************************
     // Getters
     //*************************************************************************************
@@ -43,18 +113,129 @@ public:
     size_t GetEventCount() noexcept;
     
     /**
-     *  Get the next event in the container. This removes the event from the container.
+     *  Get the service gauge set of the container.
+     *
+     *  \return The service gauge set, Metrics::us_ServiceCount if not recorded.
+     */
+    
+    size_t GetMetricsService() const noexcept;
+    
+    /**
+     *  Get the next event in the container. This removes the event from the container. 
+     *  Events are taken by priority, a lower priority lane passed over too often 
+     *  is taken from next.
      *
      *  \return The event on success, NULL if the container is empty.
      */
     
     MRH_Event* GetEvent() noexcept;
     
+    /**
+     *  Get the next event in the container without recording the time it waited. 
+     *  This removes the event from the container.
+     *
+     *  \param u64_TimeNS The time the event was added in nanoseconds, 0 if the 
+     *                    time was not recorded.
+     *  \param e_Priority The lane the event was taken from.
+     *
+     *  \return The event on success, NULL if the container is empty.
+     */
+    
+    MRH_Event* GetEvent(MRH_Uint64& u64_TimeNS, Priority& e_Priority) noexcept;
+    
+    /**
+     *  Get multiple events from the container. This removes the events from the container.
+     *
+     *  \param p_Event The buffer to write the events to.
+     *  \param us_Count The max amount of events to write.
+     *
+     *  \return The amount of events written to the buffer.
+     */
+    
+    size_t GetEvents(MRH_Event** p_Event, size_t us_Count) noexcept;
+    
 private:
     
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct Lane
+    {
+        // Ring buffer
+        std::vector<MRH_Event*> v_Event;
+        std::vector<MRH_Uint64> v_TimeNS; // Added time, by event
+        size_t us_Head;
+        size_t us_Count;
+        
+        // Events taken from higher lanes while waiting
+        size_t us_Skipped;
+    };
+    
+    struct TypePriority
+    {
+        MRH_Uint32 u32_Type;
+        Priority e_Priority;
+    };
+    
+    //*************************************************************************************
+    // Reserve
+    //*************************************************************************************
+    
+    /**
+     *  Grow the ring buffer of a lane by the reserve step.
+     *
+     *  \param c_Lane The lane to grow.
+     */
+    
+    void Reserve(Lane& c_Lane);
+    
+    //*************************************************************************************
+    // Lane
+    //*************************************************************************************
+    
+    /**
+     *  Add a event to the end of a lane.
+     *
+     *  \param p_Event The event to add. This event is consumed.
+     *  \param u64_TimeNS The time the event was added in nanoseconds.
+     *  \param e_Priority The lane to add to.
+     */
+    
+    void Push(MRH_Event*& p_Event, MRH_Uint64 u64_TimeNS, Priority e_Priority) noexcept;
+    
+    /**
+     *  Get the lane for a event type.
+     *
+     *  \param u32_Type The event type.
+     *
+     *  \return The lane of the event type.
+     */
+    
+    Priority GetPriority(MRH_Uint32 u32_Type) const noexcept;
+    
+    /**
+     *  Select the lane to take the next event from.
+     *
+     *  \return The lane index.
+     */
+    
+    size_t SelectLane() noexcept;
+    
     //*************************************************************************************
     // Data
     //*************************************************************************************
+    
+    // Lanes, by priority
+    Lane p_Lane[PRIORITY_COUNT];
+    size_t us_Count;
+    
+    // Lanes by event type, few types are mapped
+    std::vector<TypePriority> v_Priority;
+    
+    size_t us_ReserveStep;
+    bool b_Latency;
+    size_t us_MetricsService;
 
 protected:
 
@@ -65,7 +246,8 @@ protected:
     /**
      *  Default constructor.
      *
-     *  \param us_ReserveStep The amount of extra space to reserve on reallocation.
+     *  \param us_ReserveStep The initial ring buffer capacity and the amount of 
+     *                       extra space to reserve if the buffer is full.
      */
 
     EventContainer(size_t us_ReserveStep) noexcept;
@@ -96,12 +278,25 @@ protected:
     
     void AddEvent(MRH_Event*& p_Event) noexcept;
     
-    //*************************************************************************************
-    // Data
-    //*************************************************************************************
-
-    std::vector<MRH_Event*> v_Event;
-    size_t us_ReserveStep;
+    /**
+     *  Add an event taken from another container, the event keeps its lane and 
+     *  the time it was first added.
+     *
+     *  \param p_Event The event to add. This event is consumed.
+     *  \param u64_TimeNS The time the event was first added in nanoseconds.
+     *  \param e_Priority The lane of the event.
+     */
+    
+    void AddEvent(MRH_Event*& p_Event, MRH_Uint64 u64_TimeNS, Priority e_Priority) noexcept;
+    
+    /**
+     *  Add multiple events to the container.
+     *
+     *  \param p_Event The events to add. All events are consumed.
+     *  \param us_Count The amount of events to add.
+     */
+    
+    void AddEvents(MRH_Event** p_Event, size_t us_Count) noexcept;
 };
 
 #endif /* EventContainer_h */
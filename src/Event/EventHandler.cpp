@@ -22,102 +22,53 @@
 
 // Project
 #include "./EventHandler.h"
-#include "../Logger.h"
+#include "./EventPool.h"
+#include "./LibmrhevTransport.h"
+#include "./SharedMemoryTransport.h"
+#include "../Metrics.h"
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-#ifdef __MRH_MRHCKM_SUPPORTED__
-EventHandler::EventHandler(const char* p_OutputPath,
-                           const char* p_OutputKey,
-                           const char* p_EventLimit) : p_OutputEventQueue(NULL),
-                                                       p_HandlerEventContainer(NULL)
+EventHandler::EventHandler(EventTransport::Type e_Transport,
+                           const char* p_Output,
+                           const char* p_EventLimit) : p_Transport(NULL),
+                                                       p_HandlerEventContainer(NULL),
+                                                       u32_CoalesceEvents(0),
+                                                       u32_CoalesceBytes(0),
+                                                       u64_CoalesceDelayNS(0),
+                                                       u64_HeldNS(0)
 {
     // Check args
-    if (p_OutputPath == NULL || std::strlen(p_OutputPath) == 0 ||
-        p_OutputKey == NULL || std::strlen(p_OutputKey) == 0 ||
+    if (p_Output == NULL || std::strlen(p_Output) == 0 ||
         p_EventLimit == NULL || std::strlen(p_EventLimit) == 0)
     {
-        throw Exception("Invalid device info recieved!");
+        throw Exception("Invalid output recieved!");
     }
     
-    // Get param info
+    // Open output, transports throw on failure
     try
     {
-        p_OutputEventQueue = MRH_OpenOutputQueueMRHCKM(p_OutputPath, std::stoi(p_OutputKey), std::stoi(p_EventLimit));
-    }
-    catch (std::exception& e)
-    {
-        throw Exception(std::string("Failed to open event queues: ") + e.what());
-    }
-    
-    // Result
-    if (p_InputEventQueue == NULL || p_OutputEventQueue == NULL)
-    {
-        Exit();
-        
-        if (MRH_GetEventQueueError() != MRH_EV_Error_Type::MRH_EV_ERROR_NONE)
-        {
-            throw Exception(std::string("libmrhev error while initializing: ") + std::string(MRH_GetEventQueueErrorString()) + "!");
-        }
-        else
+        switch (e_Transport)
         {
-            throw Exception("Unknown libmrhev error while initializing!");
-        }
-    }
-    
-    // Create container
-    try
-    {
-        size_t us_ReserveStep;
-        
-        if ((us_ReserveStep = std::stoi(p_EventLimit)) == 0)
-        {
-            us_ReserveStep = 1;
+            case EventTransport::TRANSPORT_SHARED_MEMORY:
+                p_Transport = new SharedMemoryTransport(p_Output);
+                break;
+            
+            default:
+                p_Transport = new LibmrhevTransport(e_Transport, p_Output, p_EventLimit);
+                break;
         }
-        
-        p_HandlerEventContainer = new HandlerEventContainer();
-    }
-    catch (std::exception& e)
-    {
-        Exit();
-        
-        throw Exception("Failed to create event container: " + std::string(e.what()));
-    }
-}
-#endif
-
-EventHandler::EventHandler(const char* p_OutputFD,
-                           const char* p_EventLimit) : p_OutputEventQueue(NULL),
-                                                       p_HandlerEventContainer(NULL)
-{
-    // Check args
-    if (p_OutputFD == NULL || std::strlen(p_OutputFD) == 0 ||
-        p_EventLimit == NULL || std::strlen(p_EventLimit) == 0)
-    {
-        throw Exception("Invalid file descriptors recieved!");
-    }
-    
-    // Get param info
-    try
-    {
-        p_OutputEventQueue = MRH_OpenOutputQueuePipe(std::stoi(p_OutputFD), std::stoi(p_EventLimit));
     }
-    catch (std::exception& e)
+    catch (std::bad_alloc& e)
     {
-        throw Exception(std::string("Failed to open event queues: ") + e.what());
+        throw Exception("Failed to create event transport: " + std::string(e.what()));
     }
     
-    // Result
-    if (p_OutputEventQueue == NULL)
-    {
-        CheckLibraryError();
-        Exit();
-        
-        throw Exception(std::string("libmrhev event queue(s) failed to initialize!"));
-    }
+    // Pooling only pays off if sent events come back
+    EventPool::Singleton().SetEnabled(p_Transport->GetRecycling());
     
     // Create container
     try
@@ -150,6 +101,17 @@ EventHandler::HandlerEventContainer::HandlerEventContainer(size_t us_ReserveStep
 EventHandler::HandlerEventContainer::~HandlerEventContainer() noexcept
 {}
 
+//*************************************************************************************
+// Coalescing
+//*************************************************************************************
+
+void EventHandler::SetCoalescing(MRH_Uint32 u32_Events, MRH_Uint32 u32_Bytes, MRH_Uint32 u32_DelayUS) noexcept
+{
+    u32_CoalesceEvents = u32_Events;
+    u32_CoalesceBytes = u32_Bytes;
+    u64_CoalesceDelayNS = static_cast<MRH_Uint64>(u32_DelayUS) * 1000;
+}
+
 //*************************************************************************************
 // Update
 //*************************************************************************************
@@ -158,13 +120,34 @@ void EventHandler::SendEvent(MRH_Event*& p_Event) noexcept
 {
     if (p_Event != NULL)
     {
-        if (MRH_AddEvent(p_OutputEventQueue, &p_Event) == NULL)
+        Metrics& c_Metrics = Metrics::Singleton();
+        
+        // A rejected event goes first to keep the order, queue behind it
+        if (p_HandlerEventContainer->GetEventCount() > 0 &&
+            (p_Transport->WaitWritable(0) == false || AddEvents(p_HandlerEventContainer) == false))
         {
-            p_Event = NULL;
+            p_HandlerEventContainer->AddEvent(p_Event);
         }
         else
         {
-            CheckLibraryError();
+            switch (p_Transport->Add(p_Event))
+            {
+                case EventTransport::ADD_OK:
+                    c_Metrics.Add(Metrics::COUNTER_EVENTS_SENT, 1);
+                    break;
+                
+                case EventTransport::ADD_FULL:
+                    // Retried after sending, like rejected container events
+                    c_Metrics.Add(Metrics::COUNTER_ADD_EVENT_FAILED, 1);
+                    p_HandlerEventContainer->AddEvent(p_Event);
+                    break;
+                
+                default:
+                    c_Metrics.Add(Metrics::COUNTER_ADD_EVENT_FAILED, 1);
+                    c_Metrics.Add(Metrics::COUNTER_EVENTS_DROPPED, 1);
+                    EventPool::Singleton().Release(p_Event);
+                    break;
+            }
         }
     }
     
@@ -174,35 +157,168 @@ void EventHandler::SendEvent(MRH_Event*& p_Event) noexcept
 
 void EventHandler::SendEvents(EventContainer* p_EventContainer) noexcept
 {
-    if (p_EventContainer != NULL)
+    Send(p_EventContainer, false);
+}
+
+void EventHandler::SendEvents() noexcept
+{
+    Flush(false);
+}
+
+void EventHandler::Send(EventContainer* p_EventContainer, bool b_Force) noexcept
+{
+    // A event rejected before is added first to keep the order, no 
+    // point in trying while the output is still full
+    if (p_HandlerEventContainer->GetEventCount() == 0 || p_Transport->WaitWritable(0) == true)
     {
-        MRH_Event* p_Event;
-        
-        while ((p_Event = p_EventContainer->GetEvent()) != NULL)
+        if (AddEvents(p_HandlerEventContainer) == true && p_EventContainer != NULL)
         {
-            if (MRH_AddEvent(p_OutputEventQueue, &p_Event) != NULL)
-            {
-                CheckLibraryError();
-                break;
-            }
+            AddEvents(p_EventContainer);
         }
     }
     
+    if (p_EventContainer != NULL)
+    {
+        Metrics::Singleton().Set(p_EventContainer->GetMetricsService(), Metrics::SERVICE_GAUGE_QUEUE_DEPTH, p_EventContainer->GetEventCount());
+    }
+    
     // We try to send events even on error, maybe some events aren't sent yet
-    SendEvents();
+    Flush(b_Force);
 }
 
-void EventHandler::SendEvents() noexcept
+void EventHandler::Flush(bool b_Force) noexcept
 {
-    // Check for work
-    if (p_OutputEventQueue == NULL || MRH_CanSendEvents(p_OutputEventQueue) < 0)
+    if (p_Transport == NULL)
     {
         return;
     }
     
-    // Send events
-    MRH_SendEvents(p_OutputEventQueue);
-    CheckLibraryError();
+    if (p_Transport->GetAddedCount() == 0)
+    {
+        u64_HeldNS = 0;
+    }
+    else if (b_Force == false && u64_CoalesceDelayNS > 0)
+    {
+        MRH_Uint64 u64_TimeNS = Metrics::GetTimeNS();
+        
+        if (u64_HeldNS == 0)
+        {
+            u64_HeldNS = u64_TimeNS;
+        }
+        
+        if (GetFlushDue(u64_TimeNS) == false)
+        {
+            return;
+        }
+        
+        // Thresholds are checked first, only count sends the delay caused
+        if ((u32_CoalesceEvents == 0 || p_Transport->GetAddedCount() < u32_CoalesceEvents) &&
+            (u32_CoalesceBytes == 0 || p_Transport->GetAddedBytes() < u32_CoalesceBytes) &&
+            p_HandlerEventContainer->GetEventCount() == 0)
+        {
+            Metrics::Singleton().Add(Metrics::COUNTER_FLUSH_DELAY, 1);
+        }
+    }
+    
+    p_Transport->Send();
+    
+    // @NOTE: Events stay added if the output is full, the send stays due
+    if (p_Transport->GetAddedCount() == 0)
+    {
+        u64_HeldNS = 0;
+    }
+}
+
+bool EventHandler::GetFlushDue(MRH_Uint64 u64_TimeNS) const noexcept
+{
+    // A full output rejected events, hold nothing back
+    if (u64_CoalesceDelayNS == 0 || p_HandlerEventContainer->GetEventCount() > 0)
+    {
+        return true;
+    }
+    
+    return (u32_CoalesceEvents > 0 && p_Transport->GetAddedCount() >= u32_CoalesceEvents) ||
+           (u32_CoalesceBytes > 0 && p_Transport->GetAddedBytes() >= u32_CoalesceBytes) ||
+           u64_HeldNS == 0 ||
+           u64_TimeNS >= u64_HeldNS + u64_CoalesceDelayNS;
+}
+
+bool EventHandler::AddEvents(EventContainer* p_EventContainer) noexcept
+{
+    Metrics& c_Metrics = Metrics::Singleton();
+    MRH_Event* p_Event;
+    MRH_Uint64 u64_TimeNS;
+    EventContainer::Priority e_Priority;
+    MRH_Uint64 u64_Sent = 0;
+    bool b_Result = true;
+    
+    // The lane wait is recorded once the output took the event
+    while ((p_Event = p_EventContainer->GetEvent(u64_TimeNS, e_Priority)) != NULL)
+    {
+        EventTransport::AddResult e_Result = p_Transport->Add(p_Event);
+        
+        if (e_Result == EventTransport::ADD_OK)
+        {
+            EventContainer::RecordLatency(e_Priority, u64_TimeNS);
+            ++u64_Sent;
+            continue;
+        }
+        
+        c_Metrics.Add(Metrics::COUNTER_ADD_EVENT_FAILED, 1);
+        
+        // A full output is retried after sending, anything else is 
+        // a invalid event and recycled instead of leaking
+        if (e_Result == EventTransport::ADD_INVALID)
+        {
+            c_Metrics.Add(Metrics::COUNTER_EVENTS_DROPPED, 1);
+            EventPool::Singleton().Release(p_Event);
+            continue;
+        }
+        
+        // Still waiting, keep the lane and the time it was first added
+        p_HandlerEventContainer->AddEvent(p_Event, u64_TimeNS, e_Priority);
+        b_Result = false;
+        break;
+    }
+    
+    c_Metrics.Add(Metrics::COUNTER_EVENTS_SENT, u64_Sent);
+    
+    return b_Result;
+}
+
+bool EventHandler::Drain(EventContainer* p_EventContainer, MRH_Uint32 u32_DeadlineMS) noexcept
+{
+    MRH_Uint64 u64_Deadline = Metrics::GetTimeNS() + static_cast<MRH_Uint64>(u32_DeadlineMS) * 1000000;
+    MRH_Uint64 u64_Time;
+    
+    while (true)
+    {
+        // Nothing is held back on exit, events the transport still holds 
+        // remain even if the hold delay did not pass
+        Send(p_EventContainer, true);
+        
+        if (GetRemainingEvents(true) == false && (p_EventContainer == NULL || p_EventContainer->GetEventCount() == 0))
+        {
+            return true;
+        }
+        
+        if ((u64_Time = Metrics::GetTimeNS()) >= u64_Deadline)
+        {
+            return false;
+        }
+        
+        // Sleep until the reader made space, round up to not spin
+        WaitWritable(static_cast<int>((u64_Deadline - u64_Time + 999999) / 1000000));
+    }
+}
+
+//*************************************************************************************
+// Wait
+//*************************************************************************************
+
+bool EventHandler::WaitWritable(int i_TimeoutMS) noexcept
+{
+    return p_Transport->WaitWritable(i_TimeoutMS);
 }
 
 //*************************************************************************************
@@ -211,10 +327,12 @@ void EventHandler::SendEvents() noexcept
 
 void EventHandler::Exit() noexcept
 {
-    // Remove queues
-    p_OutputEventQueue = MRH_CloseEventQueue(p_OutputEventQueue);
-    
-    CheckLibraryError();
+    // Remove transport
+    if (p_Transport != NULL)
+    {
+        delete p_Transport;
+        p_Transport = NULL;
+    }
     
     // Remove event container
     if (p_HandlerEventContainer != NULL)
@@ -225,30 +343,48 @@ void EventHandler::Exit() noexcept
 }
 
 //*************************************************************************************
-// Error
+// Getters
 //*************************************************************************************
 
-void EventHandler::CheckLibraryError() noexcept
+bool EventHandler::GetRemainingEvents(bool b_All) const noexcept
 {
-    if (MRH_GetEventQueueError() != MRH_EV_Error_Type::MRH_EV_ERROR_NONE)
+    if (p_HandlerEventContainer != NULL && p_HandlerEventContainer->GetEventCount() > 0)
     {
-        Logger::Singleton().Log(Logger::WARNING, "libmrhev error while processing events: " +
-                                                 std::string(MRH_GetEventQueueErrorString()) +
-                                                 " (" +
-                                                 std::string(MRH_GetEventQueueErrorFile()) +
-                                                 ": " +
-                                                 std::to_string(MRH_GetEventQueueErrorFileLine()) +
-                                                 ")!",
-                                "EventHandler.cpp", __LINE__);
-        MRH_ResetEventQueueError();
+        return true;
     }
+    
+    if (p_Transport == NULL || p_Transport->GetPending() == false)
+    {
+        return false;
+    }
+    
+    return b_All == true || GetFlushDue(Metrics::GetTimeNS()) == true;
 }
 
-//*************************************************************************************
-// Getters
-//*************************************************************************************
+bool EventHandler::GetFlushDeadline(MRH_Uint64& u64_DeadlineNS) const noexcept
+{
+    if (u64_HeldNS == 0 || u64_CoalesceDelayNS == 0)
+    {
+        return false;
+    }
+    
+    // Due events wait for the output instead
+    u64_DeadlineNS = u64_HeldNS + u64_CoalesceDelayNS;
+    
+    return GetFlushDue(Metrics::GetTimeNS()) == false;
+}
+
+int EventHandler::GetOutputFD() const noexcept
+{
+    return p_Transport != NULL ? p_Transport->GetFD() : -1;
+}
+
+EventTransport const* EventHandler::GetTransport() const noexcept
+{
+    return p_Transport;
+}
 
-bool EventHandler::GetRemainingEvents() const noexcept
+bool EventHandler::GetOutputDoorbell() const noexcept
 {
-    return MRH_CanSendEvents(p_OutputEventQueue) < 0 ? false : true;
+    return p_Transport != NULL ? p_Transport->GetDoorbell() : false;
 }
@@ -20,10 +20,10 @@
 // C / C++
 
 // External
-#include <libmrhev.h>
 
 // Project
 #include "./EventContainer.h"
+#include "./EventTransport.h"
 #include "../Exception.h"
 
 
@@ -81,30 +81,18 @@ public:
     // Constructor / Destructor
     //*************************************************************************************
 
-#ifdef __MRH_MRHCKM_SUPPORTED__
     /**
-     *  MRHCKM-based constructor.
+     *  Default constructor.
      *
-     *  \param p_OutputPath The full path to the output device file.
-     *  \param p_OutputKey The output key.
-     *  \param p_EventLimit The max amount of event to be sent / recieved in a update.
+     *  \param e_Transport The transport to send events with.
+     *  \param p_Output The transport output, see the transport for the format.
+     *  \param p_EventLimit The max amount of event to be sent / recieved in a update.  
      */
     
-    EventHandler(const char* p_OutputPath,
-                 const char* p_OutputKey,
+    EventHandler(EventTransport::Type e_Transport,
+                 const char* p_Output,
                  const char* p_EventLimit);
-#endif
     
-    /**
-     *  Pipe-based constructor.
-     *
-     *  \param p_OutputFD The event queue output file descriptor.
-     *  \param p_EventLimit The max amount of event to be sent / recieved in a update.  
-     */
-
-    EventHandler(const char* p_OutputFD,
-                 const char* p_EventLimit);
-
     /**
      *  Copy constructor. Disabled for this class.
      *
@@ -118,6 +106,22 @@ public:
      */
 
     ~EventHandler() noexcept;
+    
+    //*************************************************************************************
+    // Coalescing
+    //*************************************************************************************
+    
+    /**
+     *  Hold added events back to send them together. Held events are sent once 
+     *  a threshold or the max delay is reached.
+     *
+     *  \param u32_Events The amount of events to send at once, 0 if unused.
+     *  \param u32_Bytes The event data to send at once in bytes, 0 if unused.
+     *  \param u32_DelayUS The max time to hold events in microseconds, 0 to 
+     *                     disable coalescing.
+     */
+    
+    void SetCoalescing(MRH_Uint32 u32_Events, MRH_Uint32 u32_Bytes, MRH_Uint32 u32_DelayUS) noexcept;
 
     //*************************************************************************************
     // Send
@@ -140,11 +144,36 @@ public:
     void SendEvents(EventContainer* p_EventContainer) noexcept;
     
     /**
-     *  Send remaining events to our parent.
+     *  Send remaining events to our parent. Held events are only sent once due.
      */
     
     void SendEvents() noexcept;
     
+    /**
+     *  Send all remaining events, waiting for the output to become writable.
+     *
+     *  \param p_EventContainer The events to send, NULL if none.
+     *  \param u32_DeadlineMS The max time to wait in milliseconds.
+     *
+     *  \return true if all events were sent, false if the deadline was reached.
+     */
+    
+    bool Drain(EventContainer* p_EventContainer, MRH_Uint32 u32_DeadlineMS) noexcept;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Wait until the output can be written to.
+     *
+     *  \param i_TimeoutMS The max time to wait in milliseconds.
+     *
+     *  \return true if the output is writable, false if not.
+     */
+    
+    bool WaitWritable(int i_TimeoutMS) noexcept;
+    
     //*************************************************************************************
     // Exit
     //*************************************************************************************
@@ -160,35 +189,111 @@ public:
     //*************************************************************************************
 
     /**
-     *  Get wether events remain to send or not.
+     *  Get wether events remain to send or not. Held events which are not due 
+     *  yet do not remain unless all events are requested.
+     *
+     *  \param b_All If held events which are not due yet remain.
      *
      *  \return true if events remain, false if not.
      */
     
-    bool GetRemainingEvents() const noexcept;
+    bool GetRemainingEvents(bool b_All = false) const noexcept;
+    
+    /**
+     *  Get the time held events are due to be sent.
+     *
+     *  \param u64_DeadlineNS The monotonic clock deadline in nanoseconds.
+     *
+     *  \return true if events are held, false if not.
+     */
     
+    bool GetFlushDeadline(MRH_Uint64& u64_DeadlineNS) const noexcept;
+    
+    /**
+     *  Get the output file descriptor.
+     *
+     *  \return The output file descriptor, -1 if the output has none.
+     */
+    
+    int GetOutputFD() const noexcept;
+    
+    /**
+     *  Get the transport used.
+     *
+     *  \return The event transport.
+     */
+    
+    EventTransport const* GetTransport() const noexcept;
+    
+    /**
+     *  Check if the output file descriptor signals space by becoming readable 
+     *  instead of writable.
+     *
+     *  \return true if the output is a doorbell, false if not.
+     */
+    
+    bool GetOutputDoorbell() const noexcept;
+
 private:
     
     //*************************************************************************************
-    // Error
+    // Send
     //*************************************************************************************
     
     /**
-     *  Check libmrhev for errors.
+     *  Add events to the output queue. A event rejected by a full queue is kept 
+     *  for the next send.
+     *
+     *  \param p_EventContainer The events to add.
+     *
+     *  \return true if all events were added, false if not.
+     */
+    
+    bool AddEvents(EventContainer* p_EventContainer) noexcept;
+    
+    /**
+     *  Add new and remaining events and send them.
+     *
+     *  \param p_EventContainer The events to send, NULL if none.
+     *  \param b_Force If held events should be sent before they are due.
+     */
+    
+    void Send(EventContainer* p_EventContainer, bool b_Force) noexcept;
+    
+    /**
+     *  Send added events if coalescing does not hold them back.
+     *
+     *  \param b_Force If held events should be sent before they are due.
      */
     
-    inline void CheckLibraryError() noexcept;
+    void Flush(bool b_Force) noexcept;
+    
+    /**
+     *  Check if held events are due to be sent.
+     *
+     *  \param u64_TimeNS The current monotonic clock time in nanoseconds.
+     *
+     *  \return true if due, false if not.
+     */
+    
+    bool GetFlushDue(MRH_Uint64 u64_TimeNS) const noexcept;
     
     //*************************************************************************************
     // Data
     //*************************************************************************************
 
-    // Event queue
-    MRH_OutputEventQueue* p_OutputEventQueue;
+    // Output
+    EventTransport* p_Transport;
 
     // Event storage
     HandlerEventContainer* p_HandlerEventContainer;
     
+    // Coalescing
+    MRH_Uint32 u32_CoalesceEvents;
+    MRH_Uint32 u32_CoalesceBytes;
+    MRH_Uint64 u64_CoalesceDelayNS; // 0 if disabled
+    MRH_Uint64 u64_HeldNS; // First event held, 0 if none
+
 protected:
 
 };
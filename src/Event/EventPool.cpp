@@ -0,0 +1,243 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <stdlib.h>
+#include <malloc.h>
+#include <cstring>
+
+// External
+
+// Project
+#include "./EventPool.h"
+
+// Pre-defined
+namespace
+{
+    // Smallest size class in bytes, each class doubles the size
+    constexpr size_t us_MinClassSize = 32;
+    
+    // Blocks kept per free list, everything beyond is freed
+    constexpr size_t us_MaxFreeBlocks = 256;
+    
+    // Largest usable size pooled, larger blocks are freed
+    constexpr size_t us_MaxPooledSize = (us_MinClassSize << EventPool::SIZE_CLASS_MAX) * 2;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+EventPool::EventPool() noexcept : b_Enabled(false)
+{
+    // Reserve now, adding blocks should never allocate
+    try
+    {
+        c_Header.v_Block.reserve(us_MaxFreeBlocks);
+        
+        for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+        {
+            p_Data[i].v_Block.reserve(us_MaxFreeBlocks);
+        }
+    }
+    catch (...)
+    {}
+}
+
+EventPool::~EventPool() noexcept
+{
+    for (auto& Block : c_Header.v_Block)
+    {
+        free(Block);
+    }
+    
+    for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+    {
+        for (auto& Block : p_Data[i].v_Block)
+        {
+            free(Block);
+        }
+    }
+}
+
+//*************************************************************************************
+// Singleton
+//*************************************************************************************
+
+EventPool& EventPool::Singleton() noexcept
+{
+    static EventPool c_EventPool;
+    return c_EventPool;
+}
+
+//*************************************************************************************
+// Block
+//*************************************************************************************
+
+void* EventPool::GetBlock(FreeList& c_FreeList, size_t us_Size) noexcept
+{
+    if (b_Enabled.load(std::memory_order_relaxed) == true)
+    {
+        std::lock_guard<std::mutex> c_Guard(c_FreeList.c_Mutex);
+        
+        if (c_FreeList.v_Block.size() > 0)
+        {
+            void* p_Block = c_FreeList.v_Block.back();
+            c_FreeList.v_Block.pop_back();
+            
+            return p_Block;
+        }
+    }
+    
+    // @NOTE: Blocks have to stay compatible with free(), libmrhev
+    //        frees events it consumed
+    return malloc(us_Size);
+}
+
+void EventPool::AddBlock(FreeList& c_FreeList, void* p_Block) noexcept
+{
+    if (b_Enabled.load(std::memory_order_relaxed) == true)
+    {
+        std::lock_guard<std::mutex> c_Guard(c_FreeList.c_Mutex);
+        
+        if (c_FreeList.v_Block.size() < c_FreeList.v_Block.capacity())
+        {
+            c_FreeList.v_Block.emplace_back(p_Block);
+            return;
+        }
+    }
+    
+    free(p_Block);
+}
+
+//*************************************************************************************
+// Acquire
+//*************************************************************************************
+
+MRH_Event* EventPool::Acquire(MRH_Uint32 u32_Type, MRH_Uint32 u32_DataSize) noexcept
+{
+    MRH_Event* p_Event = static_cast<MRH_Event*>(GetBlock(c_Header, sizeof(MRH_Event)));
+    
+    if (p_Event == NULL)
+    {
+        return NULL;
+    }
+    
+    std::memset(p_Event, 0, sizeof(MRH_Event));
+    p_Event->u32_Type = u32_Type;
+    
+    if (u32_DataSize == 0)
+    {
+        return p_Event;
+    }
+    
+    // Round up to the matching size class, too large data is not pooled
+    size_t us_Size = us_MinClassSize;
+    size_t us_Class = 0;
+    
+    while (us_Size < u32_DataSize && us_Class < SIZE_CLASS_COUNT)
+    {
+        us_Size <<= 1;
+        ++us_Class;
+    }
+    
+    if (us_Class < SIZE_CLASS_COUNT)
+    {
+        p_Event->p_Data = static_cast<MRH_Uint8*>(GetBlock(p_Data[us_Class], us_Size));
+    }
+    else
+    {
+        p_Event->p_Data = static_cast<MRH_Uint8*>(malloc(u32_DataSize));
+    }
+    
+    if (p_Event->p_Data == NULL)
+    {
+        AddBlock(c_Header, p_Event);
+        return NULL;
+    }
+    
+    p_Event->u32_DataSize = u32_DataSize;
+    
+    return p_Event;
+}
+
+MRH_Event* EventPool::AcquireEvent(MRH_Uint32 u32_Type, MRH_Uint32 u32_DataSize) noexcept
+{
+    return Singleton().Acquire(u32_Type, u32_DataSize);
+}
+
+//*************************************************************************************
+// Release
+//*************************************************************************************
+
+void EventPool::Release(MRH_Event*& p_Event) noexcept
+{
+    if (p_Event == NULL)
+    {
+        return;
+    }
+    
+    if (p_Event->p_Data != NULL)
+    {
+        // Sort by the usable size, works for pool and malloc() data alike
+        size_t us_Usable = malloc_usable_size(p_Event->p_Data);
+        
+        if (us_Usable < us_MinClassSize || us_Usable > us_MaxPooledSize)
+        {
+            free(p_Event->p_Data);
+        }
+        else
+        {
+            size_t us_Size = us_MinClassSize;
+            size_t us_Class = 0;
+            
+            while ((us_Size << 1) <= us_Usable && us_Class < SIZE_CLASS_MAX)
+            {
+                us_Size <<= 1;
+                ++us_Class;
+            }
+            
+            AddBlock(p_Data[us_Class], p_Event->p_Data);
+        }
+    }
+    
+    AddBlock(c_Header, p_Event);
+    p_Event = NULL;
+}
+
+void EventPool::ReleaseEvent(MRH_Event* p_Event) noexcept
+{
+    Singleton().Release(p_Event);
+}
+
+//*************************************************************************************
+// Setters
+//*************************************************************************************
+
+void EventPool::SetEnabled(bool b_Enabled) noexcept
+{
+    this->b_Enabled.store(b_Enabled, std::memory_order_relaxed);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool EventPool::GetEnabled() const noexcept
+{
+    return b_Enabled.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,212 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef EventPool_h
+#define EventPool_h
+
+// C / C++
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+
+
+class EventPool
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        SIZE_CLASS_32 = 0,
+        SIZE_CLASS_64 = 1,
+        SIZE_CLASS_128 = 2,
+        SIZE_CLASS_256 = 3,
+        SIZE_CLASS_512 = 4,
+        SIZE_CLASS_1024 = 5,
+        SIZE_CLASS_2048 = 6,
+        SIZE_CLASS_4096 = 7,
+        
+        SIZE_CLASS_MAX = SIZE_CLASS_4096,
+        
+        SIZE_CLASS_COUNT = SIZE_CLASS_MAX + 1
+    
+    }SizeClass;
+    
+    //*************************************************************************************
+    // Singleton
+    //*************************************************************************************
+    
+    /**
+     *  Get the class instance. This function is thread safe.
+     *
+     *  \return The class instance.
+     */
+    
+    static EventPool& Singleton() noexcept;
+    
+    //*************************************************************************************
+    // Acquire
+    //*************************************************************************************
+    
+    /**
+     *  Get a event from the pool. This function is thread safe.
+     *
+     *  \param u32_Type The event type.
+     *  \param u32_DataSize The event data size in bytes.
+     *
+     *  \return The event on success, NULL on failure.
+     */
+    
+    MRH_Event* Acquire(MRH_Uint32 u32_Type, MRH_Uint32 u32_DataSize) noexcept;
+    
+    /**
+     *  Get a event from the pool. This function is meant to be given to the
+     *  application service as a callback.
+     *
+     *  \param u32_Type The event type.
+     *  \param u32_DataSize The event data size in bytes.
+     *
+     *  \return The event on success, NULL on failure.
+     */
+    
+    static MRH_Event* AcquireEvent(MRH_Uint32 u32_Type, MRH_Uint32 u32_DataSize) noexcept;
+    
+    //*************************************************************************************
+    // Release
+    //*************************************************************************************
+    
+    /**
+     *  Return a event to the pool. The event may be allocated by malloc() instead
+     *  of the pool. This function is thread safe.
+     *
+     *  \param p_Event The event to return. The event is consumed.
+     */
+    
+    void Release(MRH_Event*& p_Event) noexcept;
+    
+    /**
+     *  Return a event to the pool. This function is meant to be given to the
+     *  application service as a callback.
+     *
+     *  \param p_Event The event to return.
+     */
+    
+    static void ReleaseEvent(MRH_Event* p_Event) noexcept;
+    
+    //*************************************************************************************
+    // Setters
+    //*************************************************************************************
+    
+    /**
+     *  Set wether freed blocks are kept for reuse or not. A disabled pool 
+     *  allocates and frees every block. This function is thread safe.
+     *
+     *  \param b_Enabled If blocks are kept.
+     */
+    
+    void SetEnabled(bool b_Enabled) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get wether freed blocks are kept for reuse or not. This function is thread safe.
+     *
+     *  \return true if blocks are kept, false if not.
+     */
+    
+    bool GetEnabled() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct FreeList
+    {
+        std::mutex c_Mutex;
+        std::vector<void*> v_Block;
+    };
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     */
+    
+    EventPool() noexcept;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~EventPool() noexcept;
+    
+    //*************************************************************************************
+    // Block
+    //*************************************************************************************
+    
+    /**
+     *  Get a block from a free list or allocate a new one.
+     *
+     *  \param c_FreeList The free list to use.
+     *  \param us_Size The block size in bytes.
+     *
+     *  \return The block on success, NULL on failure.
+     */
+    
+    void* GetBlock(FreeList& c_FreeList, size_t us_Size) noexcept;
+    
+    /**
+     *  Add a block to a free list or free it if the list is full.
+     *
+     *  \param c_FreeList The free list to use.
+     *  \param p_Block The block to add.
+     */
+    
+    void AddBlock(FreeList& c_FreeList, void* p_Block) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Only enabled if events are returned
+    std::atomic<bool> b_Enabled;
+    
+    // Event headers
+    FreeList c_Header;
+    
+    // Event data, by size class
+    FreeList p_Data[SIZE_CLASS_COUNT];
+
+protected:
+
+};
+
+#endif /* EventPool_h */
@@ -0,0 +1,130 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+
+// External
+
+// Project
+#include "./EventRateLimiter.h"
+
+// Pre-defined
+namespace
+{
+    // Token fraction units per token
+    constexpr MRH_Uint64 u64_TokenUnit = 1000000000;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+EventRateLimiter::EventRateLimiter() noexcept
+{}
+
+EventRateLimiter::~EventRateLimiter() noexcept
+{}
+
+//*************************************************************************************
+// Quota
+//*************************************************************************************
+
+void EventRateLimiter::SetQuota(MRH_Uint32 u32_Type, MRH_Uint32 u32_RatePerS, MRH_Uint32 u32_Burst)
+{
+    Bucket c_Bucket;
+    
+    c_Bucket.u32_Type = u32_Type;
+    c_Bucket.u64_RatePerS = u32_RatePerS;
+    c_Bucket.u64_Capacity = static_cast<MRH_Uint64>(u32_Burst) * u64_TokenUnit;
+    c_Bucket.u64_Tokens = c_Bucket.u64_Capacity;
+    c_Bucket.u64_UpdateNS = 0;
+    c_Bucket.u64_OverQuota = 0;
+    
+    for (auto& Bucket : v_Bucket)
+    {
+        if (Bucket.u32_Type == u32_Type)
+        {
+            Bucket = c_Bucket;
+            return;
+        }
+    }
+    
+    v_Bucket.emplace_back(c_Bucket);
+}
+
+//*************************************************************************************
+// Take
+//*************************************************************************************
+
+bool EventRateLimiter::Take(MRH_Uint32 u32_Type, MRH_Uint64 u64_TimeNS) noexcept
+{
+    for (auto& Bucket : v_Bucket)
+    {
+        if (Bucket.u32_Type != u32_Type)
+        {
+            continue;
+        }
+        
+        // Refill for the time passed, a full bucket stays full
+        if (Bucket.u64_UpdateNS != 0 && u64_TimeNS > Bucket.u64_UpdateNS && Bucket.u64_RatePerS > 0)
+        {
+            MRH_Uint64 u64_Missing = Bucket.u64_Capacity - Bucket.u64_Tokens;
+            MRH_Uint64 u64_ElapsedNS = u64_TimeNS - Bucket.u64_UpdateNS;
+            
+            if (u64_ElapsedNS >= u64_Missing / Bucket.u64_RatePerS)
+            {
+                Bucket.u64_Tokens = Bucket.u64_Capacity;
+            }
+            else
+            {
+                Bucket.u64_Tokens += u64_ElapsedNS * Bucket.u64_RatePerS;
+            }
+        }
+        
+        Bucket.u64_UpdateNS = u64_TimeNS;
+        
+        if (Bucket.u64_Tokens < u64_TokenUnit)
+        {
+            ++(Bucket.u64_OverQuota);
+            return false;
+        }
+        
+        Bucket.u64_Tokens -= u64_TokenUnit;
+        return true;
+    }
+    
+    return true;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+size_t EventRateLimiter::GetQuotaCount() const noexcept
+{
+    return v_Bucket.size();
+}
+
+MRH_Uint32 EventRateLimiter::GetType(size_t us_Quota) const noexcept
+{
+    return us_Quota < v_Bucket.size() ? v_Bucket[us_Quota].u32_Type : 0;
+}
+
+MRH_Uint64 EventRateLimiter::GetOverQuota(size_t us_Quota) const noexcept
+{
+    return us_Quota < v_Bucket.size() ? v_Bucket[us_Quota].u64_OverQuota : 0;
+}
@@ -0,0 +1,148 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef EventRateLimiter_h
+#define EventRateLimiter_h
+
+// C / C++
+#include <cstddef>
+#include <vector>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+
+class EventRateLimiter
+{
+public:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. No event type is limited.
+     */
+    
+    EventRateLimiter() noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_EventRateLimiter EventRateLimiter class source.
+     */
+    
+    EventRateLimiter(EventRateLimiter const& c_EventRateLimiter) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~EventRateLimiter() noexcept;
+    
+    //*************************************************************************************
+    // Quota
+    //*************************************************************************************
+    
+    /**
+     *  Limit a event type with a token bucket. The bucket starts full. A existing 
+     *  quota for the event type is replaced.
+     *
+     *  \param u32_Type The event type to limit.
+     *  \param u32_RatePerS The tokens added per second.
+     *  \param u32_Burst The max tokens held by the bucket.
+     */
+    
+    void SetQuota(MRH_Uint32 u32_Type, MRH_Uint32 u32_RatePerS, MRH_Uint32 u32_Burst);
+    
+    //*************************************************************************************
+    // Take
+    //*************************************************************************************
+    
+    /**
+     *  Take a token for a event. Event types without a quota always get one.
+     *
+     *  \param u32_Type The event type.
+     *  \param u64_TimeNS The current monotonic clock time in nanoseconds.
+     *
+     *  \return true if the event is within the quota, false if not.
+     */
+    
+    bool Take(MRH_Uint32 u32_Type, MRH_Uint64 u64_TimeNS) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the amount of limited event types.
+     *
+     *  \return The quota count.
+     */
+    
+    size_t GetQuotaCount() const noexcept;
+    
+    /**
+     *  Get the event type of a quota.
+     *
+     *  \param us_Quota The quota index.
+     *
+     *  \return The event type.
+     */
+    
+    MRH_Uint32 GetType(size_t us_Quota) const noexcept;
+    
+    /**
+     *  Get the amount of events over a quota.
+     *
+     *  \param us_Quota The quota index.
+     *
+     *  \return The events over quota.
+     */
+    
+    MRH_Uint64 GetOverQuota(size_t us_Quota) const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // @NOTE: Tokens are counted in billionths, refilled per nanosecond
+    struct Bucket
+    {
+        MRH_Uint32 u32_Type;
+        MRH_Uint64 u64_RatePerS;
+        MRH_Uint64 u64_Capacity;
+        MRH_Uint64 u64_Tokens;
+        MRH_Uint64 u64_UpdateNS; // 0 if never updated
+        MRH_Uint64 u64_OverQuota;
+    };
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Few types are limited, searched in order
+    std::vector<Bucket> v_Bucket;
+
+protected:
+
+};
+
+#endif /* EventRateLimiter_h */
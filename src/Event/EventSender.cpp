@@ -0,0 +1,219 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <chrono>
+
+// External
+
+// Project
+#include "./EventSender.h"
+#include "../Logger.h"
+#include "../Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Events moved per batch between containers and the queue
+    constexpr size_t us_BatchSize = 64;
+    
+    // Max time to wait for the output before checking for a stop
+    constexpr int i_OutputWaitMS = 100;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+EventSender::EventSender(EventHandler* p_EventHandler,
+                         size_t us_EventLimit,
+                         EventContainer* p_EventContainer) : p_EventHandler(p_EventHandler),
+                                                                     c_Queue(us_EventLimit * 2),
+                                                                     c_Container(us_EventLimit),
+                                                                     b_Wake(false),
+                                                                     b_Run(true)
+{
+    if (p_EventHandler == NULL)
+    {
+        throw Exception("Invalid event handler recieved!");
+    }
+    else if (p_EventContainer == NULL)
+    {
+        throw Exception("Invalid event container recieved!");
+    }
+    
+    // Events only pass through the pushing container, they wait here
+    try
+    {
+        c_Container.SetPriority(*p_EventContainer);
+    }
+    catch (std::exception& e)
+    {
+        throw Exception("Failed to set event priorities: " + std::string(e.what()));
+    }
+    
+    c_Container.SetLatency(true);
+    c_Container.SetMetricsService(p_EventContainer->GetMetricsService());
+    p_EventContainer->SetLatency(false);
+    
+    try
+    {
+        c_Thread = std::thread(Run, this);
+    }
+    catch (std::exception& e)
+    {
+        throw Exception("Failed to start sender thread: " + std::string(e.what()));
+    }
+}
+
+EventSender::~EventSender() noexcept
+{
+    Stop();
+}
+
+EventSender::SenderEventContainer::SenderEventContainer(size_t us_ReserveStep) noexcept : EventContainer(us_ReserveStep)
+{}
+
+EventSender::SenderEventContainer::~SenderEventContainer() noexcept
+{}
+
+//*************************************************************************************
+// Push
+//*************************************************************************************
+
+void EventSender::Push(EventContainer* p_EventContainer) noexcept
+{
+    if (p_EventContainer == NULL || p_EventContainer->GetEventCount() == 0)
+    {
+        return;
+    }
+    
+    MRH_Event* p_Batch[us_BatchSize];
+    size_t us_Free;
+    size_t us_Count;
+    
+    while ((us_Free = c_Queue.GetFreeCount()) > 0)
+    {
+        if ((us_Count = p_EventContainer->GetEvents(p_Batch, us_Free < us_BatchSize ? us_Free : us_BatchSize)) == 0)
+        {
+            break;
+        }
+        
+        c_Queue.Push(p_Batch, us_Count);
+    }
+    
+    Metrics::Singleton().Set(Metrics::GAUGE_SENDER_QUEUE_DEPTH, c_Queue.GetEventCount());
+    
+    // Wake the sender, locked to not miss a waiting sender
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        b_Wake = true;
+    }
+    
+    c_Condition.notify_one();
+}
+
+//*************************************************************************************
+// Stop
+//*************************************************************************************
+
+void EventSender::Stop() noexcept
+{
+    if (c_Thread.joinable() == false)
+    {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        b_Run = false;
+    }
+    
+    c_Condition.notify_one();
+    c_Thread.join();
+}
+
+//*************************************************************************************
+// Run
+//*************************************************************************************
+
+void EventSender::Run(EventSender* p_Instance) noexcept
+{
+    while (p_Instance->b_Run == true)
+    {
+        // Unsent events wait for the output, otherwise wait for new ones
+        if (p_Instance->c_Container.GetEventCount() > 0 || p_Instance->p_EventHandler->GetRemainingEvents() == true)
+        {
+            p_Instance->p_EventHandler->WaitWritable(i_OutputWaitMS);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> c_Lock(p_Instance->c_Mutex);
+            auto Wake = [p_Instance] { return p_Instance->b_Wake == true || p_Instance->b_Run == false; };
+            MRH_Uint64 u64_DeadlineNS;
+            
+            // Held events are sent on their deadline
+            if (p_Instance->p_EventHandler->GetFlushDeadline(u64_DeadlineNS) == true)
+            {
+                MRH_Uint64 u64_TimeNS = Metrics::GetTimeNS();
+                
+                p_Instance->c_Condition.wait_for(c_Lock,
+                                                 std::chrono::nanoseconds(u64_DeadlineNS > u64_TimeNS ? u64_DeadlineNS - u64_TimeNS : 0),
+                                                 Wake);
+            }
+            else
+            {
+                p_Instance->c_Condition.wait(c_Lock, Wake);
+            }
+        }
+        
+        {
+            std::lock_guard<std::mutex> c_Guard(p_Instance->c_Mutex);
+            p_Instance->b_Wake = false;
+        }
+        
+        p_Instance->Send();
+    }
+    
+    // Hand over everything left, the caller sends the remaining events
+    p_Instance->Send();
+}
+
+void EventSender::Send() noexcept
+{
+    MRH_Event* p_Batch[us_BatchSize];
+    size_t us_Count;
+    
+    while ((us_Count = c_Queue.Pop(p_Batch, us_BatchSize)) > 0)
+    {
+        for (size_t i = 0; i < us_Count; ++i)
+        {
+            c_Container.AddEvent(p_Batch[i]);
+        }
+    }
+    
+    p_EventHandler->SendEvents(&c_Container);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+EventContainer* EventSender::GetRemainingEvents() noexcept
+{
+    return &c_Container;
+}
@@ -0,0 +1,188 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef EventSender_h
+#define EventSender_h
+
+// C / C++
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// External
+
+// Project
+#include "./EventHandler.h"
+#include "./SPSCEventQueue.h"
+
+
+class EventSender
+{
+public:
+
+    //*************************************************************************************
+    // Event Container
+    //*************************************************************************************
+    
+    class SenderEventContainer : public EventContainer
+    {
+        friend class EventSender;
+    
+    public:
+    
+    private:
+        
+        //*************************************************************************************
+        // Constructor / Destructor
+        //*************************************************************************************
+        
+        /**
+         *  Default constructor.
+         *
+         *  \param us_ReserveStep The amount of extra space to reserve on reallocation.
+         */
+        
+        SenderEventContainer(size_t us_ReserveStep) noexcept;
+        
+        /**
+         *  Copy constructor. Disabled for this class.
+         *
+         *  \param c_SenderEventContainer SenderEventContainer class source.
+         */
+        
+        SenderEventContainer(SenderEventContainer const& c_SenderEventContainer) = delete;
+        
+        /**
+         *  Default destructor.
+         */
+        
+        ~SenderEventContainer() noexcept;
+    
+    protected:
+    
+    };
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. The sender thread is started on construction.
+     *
+     *  \param p_EventHandler The event handler used by the sender thread.
+     *  \param us_EventLimit The max amount of events recieved in a update.
+     *  \param p_EventContainer The container events are pushed from. The sender 
+     *                          uses the same lanes and records the lane latency 
+     *                          in place of this container.
+     */
+    
+    EventSender(EventHandler* p_EventHandler,
+                size_t us_EventLimit,
+                EventContainer* p_EventContainer);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_EventSender EventSender class source.
+     */
+    
+    EventSender(EventSender const& c_EventSender) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~EventSender() noexcept;
+    
+    //*************************************************************************************
+    // Push
+    //*************************************************************************************
+    
+    /**
+     *  Hand events to the sender thread. Events which do not fit are kept in the
+     *  given container.
+     *
+     *  \param p_EventContainer The events to send.
+     */
+    
+    void Push(EventContainer* p_EventContainer) noexcept;
+    
+    //*************************************************************************************
+    // Stop
+    //*************************************************************************************
+    
+    /**
+     *  Stop the sender thread. All queued events are handed to the event handler
+     *  before the thread stops.
+     */
+    
+    void Stop() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the events not sent by the sender thread. Only valid after the sender 
+     *  thread was stopped.
+     *
+     *  \return The remaining events.
+     */
+    
+    EventContainer* GetRemainingEvents() noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Run
+    //*************************************************************************************
+    
+    /**
+     *  Sender thread function.
+     *
+     *  \param p_Instance The sender instance to run.
+     */
+    
+    static void Run(EventSender* p_Instance) noexcept;
+    
+    /**
+     *  Move queued events to the event handler and send them.
+     */
+    
+    void Send() noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Events
+    EventHandler* p_EventHandler;
+    SPSCEventQueue c_Queue;
+    SenderEventContainer c_Container;
+    
+    // Thread
+    std::thread c_Thread;
+    std::mutex c_Mutex;
+    std::condition_variable c_Condition;
+    bool b_Wake;
+    std::atomic<bool> b_Run;
+
+protected:
+
+};
+
+#endif /* EventSender_h */
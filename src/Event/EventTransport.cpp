@@ -0,0 +1,128 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <cstring>
+
+// External
+
+// Project
+#include "./EventTransport.h"
+#include "../Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Names used by the transport parameter, by type
+    const char* p_TransportName[EventTransport::TRANSPORT_COUNT] =
+    {
+        "pipe",
+        "mrhckm",
+        "shm"
+    };
+    
+    static_assert(EventTransport::TRANSPORT_COUNT <= Metrics::us_TransportCount, "Missing transport metrics!");
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+EventTransport::EventTransport(Type e_Type) noexcept : e_Type(e_Type),
+                                                       u64_Added(0),
+                                                       u64_AddedBytes(0),
+                                                       u64_Full(0)
+{}
+
+EventTransport::~EventTransport() noexcept
+{}
+
+//*************************************************************************************
+// Metrics
+//*************************************************************************************
+
+void EventTransport::RecordAdded(MRH_Uint32 u32_DataSize) noexcept
+{
+    ++u64_Added;
+    u64_AddedBytes += u32_DataSize;
+}
+
+void EventTransport::RecordFull() noexcept
+{
+    u64_Full.fetch_add(1, std::memory_order_relaxed);
+    Metrics::Singleton().Add(e_Type, Metrics::TRANSPORT_COUNTER_FULL, 1);
+}
+
+void EventTransport::RecordSend(MRH_Uint64 u64_TimeNS) noexcept
+{
+    Metrics& c_Metrics = Metrics::Singleton();
+    
+    c_Metrics.Add(e_Type, Metrics::TRANSPORT_COUNTER_EVENTS, u64_Added);
+    c_Metrics.Add(e_Type, Metrics::TRANSPORT_COUNTER_BYTES, u64_AddedBytes);
+    c_Metrics.Add(e_Type, Metrics::TRANSPORT_COUNTER_SENDS, 1);
+    c_Metrics.Add(e_Type, Metrics::TRANSPORT_COUNTER_SEND_TIME_NS, u64_TimeNS);
+    c_Metrics.Add(Metrics::COUNTER_SEND_TIME_NS, u64_TimeNS);
+    c_Metrics.Record(Metrics::HISTOGRAM_SEND_US, u64_TimeNS / 1000);
+    c_Metrics.Record(Metrics::HISTOGRAM_BATCH_EVENTS, u64_Added);
+    c_Metrics.Record(Metrics::HISTOGRAM_BATCH_BYTES, u64_AddedBytes);
+    
+    u64_Added = 0;
+    u64_AddedBytes = 0;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint64 EventTransport::GetAddedCount() const noexcept
+{
+    return u64_Added;
+}
+
+MRH_Uint64 EventTransport::GetAddedBytes() const noexcept
+{
+    return u64_AddedBytes;
+}
+
+MRH_Uint64 EventTransport::GetFullCount() const noexcept
+{
+    return u64_Full.load(std::memory_order_relaxed);
+}
+
+EventTransport::Type EventTransport::GetType() const noexcept
+{
+    return e_Type;
+}
+
+const char* EventTransport::GetName() const noexcept
+{
+    return p_TransportName[e_Type];
+}
+
+bool EventTransport::GetType(const char* p_Name, Type& e_Type) noexcept
+{
+    for (size_t i = 0; i < TRANSPORT_COUNT; ++i)
+    {
+        if (std::strcmp(p_Name, p_TransportName[i]) == 0)
+        {
+            e_Type = static_cast<Type>(i);
+            return true;
+        }
+    }
+    
+    return false;
+}
@@ -0,0 +1,264 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef EventTransport_h
+#define EventTransport_h
+
+// C / C++
+#include <atomic>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+#include "../Exception.h"
+
+
+class EventTransport
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        TRANSPORT_PIPE = 0,
+        TRANSPORT_MRHCKM = 1,
+        TRANSPORT_SHARED_MEMORY = 2,
+        
+        TRANSPORT_MAX = TRANSPORT_SHARED_MEMORY,
+        
+        TRANSPORT_COUNT = TRANSPORT_MAX + 1
+    
+    }Type;
+    
+    typedef enum
+    {
+        ADD_OK = 0,
+        ADD_FULL = 1,
+        ADD_INVALID = 2,
+        
+        ADD_RESULT_MAX = ADD_INVALID,
+        
+        ADD_RESULT_COUNT = ADD_RESULT_MAX + 1
+    
+    }AddResult;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_EventTransport EventTransport class source.
+     */
+    
+    EventTransport(EventTransport const& c_EventTransport) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    virtual ~EventTransport() noexcept;
+    
+    //*************************************************************************************
+    // Add
+    //*************************************************************************************
+    
+    /**
+     *  Add a event to the output.
+     *
+     *  \param p_Event The event to add. The event is consumed on success.
+     *
+     *  \return The add result.
+     */
+    
+    virtual AddResult Add(MRH_Event*& p_Event) noexcept = 0;
+    
+    //*************************************************************************************
+    // Send
+    //*************************************************************************************
+    
+    /**
+     *  Send all added events without blocking.
+     */
+    
+    virtual void Send() noexcept = 0;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Wait until the output can take more events.
+     *
+     *  \param i_TimeoutMS The max time to wait in milliseconds.
+     *
+     *  \return true if sending should be retried, false if not.
+     */
+    
+    virtual bool WaitWritable(int i_TimeoutMS) noexcept = 0;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the transport type.
+     *
+     *  \return The transport type.
+     */
+    
+    Type GetType() const noexcept;
+    
+    /**
+     *  Get the transport name.
+     *
+     *  \return The transport name.
+     */
+    
+    const char* GetName() const noexcept;
+    
+    /**
+     *  Get the transport type for a name.
+     *
+     *  \param p_Name The transport name.
+     *  \param e_Type The transport type for the name.
+     *
+     *  \return true if the name is known, false if not.
+     */
+    
+    static bool GetType(const char* p_Name, Type& e_Type) noexcept;
+    
+    /**
+     *  Get the amount of events added since the last send.
+     *
+     *  \return The event count.
+     */
+    
+    MRH_Uint64 GetAddedCount() const noexcept;
+    
+    /**
+     *  Get the event data added since the last send.
+     *
+     *  \return The data size in bytes.
+     */
+    
+    MRH_Uint64 GetAddedBytes() const noexcept;
+    
+    /**
+     *  Get wether added events wait to be sent or not.
+     *
+     *  \return true if events wait, false if not.
+     */
+    
+    virtual bool GetPending() const noexcept = 0;
+    
+    /**
+     *  Get the output file descriptor to wait on.
+     *
+     *  \return The output file descriptor, -1 if the output has none.
+     */
+    
+    virtual int GetFD() const noexcept = 0;
+    
+    /**
+     *  Check if the output file descriptor signals space by becoming readable 
+     *  instead of writable.
+     *
+     *  \return true if the output is a doorbell, false if not.
+     */
+    
+    virtual bool GetDoorbell() const noexcept = 0;
+    
+    /**
+     *  Check if events given to the transport are returned to the event pool.
+     *
+     *  \return true if events are returned, false if not.
+     */
+    
+    virtual bool GetRecycling() const noexcept = 0;
+    
+    /**
+     *  Get the amount of events rejected by a full output. This function is 
+     *  thread safe.
+     *
+     *  \return The amount of rejected events.
+     */
+    
+    MRH_Uint64 GetFullCount() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    Type e_Type;
+    
+    // Added since the last send
+    MRH_Uint64 u64_Added;
+    MRH_Uint64 u64_AddedBytes;
+    
+    // Events rejected by a full output, read by other threads
+    std::atomic<MRH_Uint64> u64_Full;
+
+protected:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param e_Type The transport type.
+     */
+    
+    EventTransport(Type e_Type) noexcept;
+    
+    //*************************************************************************************
+    // Metrics
+    //*************************************************************************************
+    
+    /**
+     *  Record a event added to the output. Added events are published with the 
+     *  next recorded send.
+     *
+     *  \param u32_DataSize The event data size in bytes.
+     */
+    
+    void RecordAdded(MRH_Uint32 u32_DataSize) noexcept;
+    
+    /**
+     *  Record a add rejected by a full output.
+     */
+    
+    void RecordFull() noexcept;
+    
+    /**
+     *  Record a send which wrote events.
+     *
+     *  \param u64_TimeNS The send duration in nanoseconds.
+     */
+    
+    void RecordSend(MRH_Uint64 u64_TimeNS) noexcept;
+};
+
+#endif /* EventTransport_h */
@@ -0,0 +1,334 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <cstring>
+#include <cstdint>
+#include <string>
+
+// External
+
+// Project
+#include "./LibmrhevTransport.h"
+#include "../Logger.h"
+#include "../Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Wait between send retries without a output file descriptor
+    constexpr int i_NoFDRetryMS = 5;
+    
+    // Bytes written per event besides the event data, rounded up
+    constexpr MRH_Uint64 u64_EventHeaderSize = 16;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+LibmrhevTransport::LibmrhevTransport(Type e_Type,
+                                     const char* p_Output,
+                                     const char* p_EventLimit) : EventTransport(e_Type),
+                                                                 p_OutputEventQueue(NULL),
+                                                                 i_OutputFD(-1),
+                                                                 u64_PipeSize(0),
+                                                                 u64_SendSpace(0)
+{
+    // Check args
+    if (p_Output == NULL || std::strlen(p_Output) == 0 ||
+        p_EventLimit == NULL || std::strlen(p_EventLimit) == 0)
+    {
+        throw Exception("Invalid output recieved!");
+    }
+    
+    // Get param info
+    try
+    {
+        if (e_Type == TRANSPORT_MRHCKM)
+        {
+#ifdef __MRH_MRHCKM_SUPPORTED__
+            // The device path may contain commas, the key does not
+            std::string s_Output(p_Output);
+            size_t us_Split = s_Output.find_last_of(',');
+            
+            if (us_Split == std::string::npos || us_Split == 0)
+            {
+                throw Exception("Invalid MRHCKM output recieved!");
+            }
+            
+            p_OutputEventQueue = MRH_OpenOutputQueueMRHCKM(s_Output.substr(0, us_Split).c_str(), 
+                                                           std::stoi(s_Output.substr(us_Split + 1)), 
+                                                           std::stoi(p_EventLimit));
+#else
+            throw Exception("MRHCKM transport not supported!");
+#endif
+        }
+        else
+        {
+            i_OutputFD = std::stoi(p_Output);
+            p_OutputEventQueue = MRH_OpenOutputQueuePipe(i_OutputFD, std::stoi(p_EventLimit));
+        }
+    }
+    catch (Exception&)
+    {
+        throw;
+    }
+    catch (std::exception& e)
+    {
+        throw Exception(std::string("Failed to open event queues: ") + e.what());
+    }
+    
+    // Result
+    if (p_OutputEventQueue == NULL)
+    {
+        if (MRH_GetEventQueueError() != MRH_EV_Error_Type::MRH_EV_ERROR_NONE)
+        {
+            std::string s_Error(MRH_GetEventQueueErrorString());
+            MRH_ResetEventQueueError();
+            
+            throw Exception("libmrhev error while initializing: " + s_Error + "!");
+        }
+        
+        throw Exception("Unknown libmrhev error while initializing!");
+    }
+    
+    // The free space of a pipe is known, other outputs only 
+    // guarantee PIPE_BUF bytes once writable
+#ifdef F_GETPIPE_SZ
+    struct stat c_Stat;
+    int i_PipeSize;
+    
+    if (i_OutputFD >= 0 && fstat(i_OutputFD, &c_Stat) == 0 && S_ISFIFO(c_Stat.st_mode) &&
+        (i_PipeSize = fcntl(i_OutputFD, F_GETPIPE_SZ)) > 0)
+    {
+        u64_PipeSize = static_cast<MRH_Uint64>(i_PipeSize);
+    }
+#endif
+}
+
+LibmrhevTransport::~LibmrhevTransport() noexcept
+{
+    p_OutputEventQueue = MRH_CloseEventQueue(p_OutputEventQueue);
+    
+    CheckLibraryError();
+}
+
+//*************************************************************************************
+// Add
+//*************************************************************************************
+
+EventTransport::AddResult LibmrhevTransport::Add(MRH_Event*& p_Event) noexcept
+{
+    MRH_Uint32 u32_DataSize = p_Event->u32_DataSize;
+    MRH_Uint64 u64_Added = GetAddedBytes() + GetAddedCount() * u64_EventHeaderSize;
+    MRH_Uint64 u64_Size = u32_DataSize + u64_EventHeaderSize;
+    
+    // Only add what the next send can write without blocking, space 
+    // only grows until then. A event which never fits is sent alone 
+    // once the output is empty
+    if (GetAddedCount() == 0)
+    {
+        u64_SendSpace = GetSpace();
+    }
+    
+    if (u64_Added + u64_Size > u64_SendSpace &&
+        (u64_Added > 0 || u64_Size <= GetMaxSpace() || u64_SendSpace < GetMaxSpace()))
+    {
+        RecordFull();
+        return ADD_FULL;
+    }
+    
+    if (MRH_AddEvent(p_OutputEventQueue, &p_Event) == NULL)
+    {
+        p_Event = NULL;
+        RecordAdded(u32_DataSize);
+        
+        return ADD_OK;
+    }
+    
+    CheckLibraryError();
+    
+    // Only a full queue has events left to send
+    if (MRH_CanSendEvents(p_OutputEventQueue) < 0)
+    {
+        return ADD_INVALID;
+    }
+    
+    RecordFull();
+    
+    return ADD_FULL;
+}
+
+//*************************************************************************************
+// Send
+//*************************************************************************************
+
+void LibmrhevTransport::Send() noexcept
+{
+    // Check for work
+    if (MRH_CanSendEvents(p_OutputEventQueue) < 0)
+    {
+        return;
+    }
+    
+    // Events were added for the space the output had, wait for 
+    // the reader if it is full again
+    if (WaitWritable(0) == false)
+    {
+        return;
+    }
+    
+    // Send events, the time shows pipe backpressure
+    MRH_Uint64 u64_Start = Metrics::GetTimeNS();
+    
+    MRH_SendEvents(p_OutputEventQueue);
+    
+    RecordSend(Metrics::GetTimeNS() - u64_Start);
+    CheckLibraryError();
+}
+
+//*************************************************************************************
+// Wait
+//*************************************************************************************
+
+bool LibmrhevTransport::WaitWritable(int i_TimeoutMS) noexcept
+{
+    // No file descriptor to wait on, retry later
+    if (i_OutputFD < 0)
+    {
+        if (i_TimeoutMS > 0)
+        {
+            poll(NULL, 0, i_TimeoutMS < i_NoFDRetryMS ? i_TimeoutMS : i_NoFDRetryMS);
+        }
+        
+        return true;
+    }
+    
+    struct pollfd c_Output;
+    
+    c_Output.fd = i_OutputFD;
+    c_Output.events = POLLOUT;
+    c_Output.revents = 0;
+    
+    // Errors are reported by libmrhev on send
+    return poll(&c_Output, 1, i_TimeoutMS) > 0 ? true : false;
+}
+
+//*************************************************************************************
+// Space
+//*************************************************************************************
+
+MRH_Uint64 LibmrhevTransport::GetSpace() const noexcept
+{
+    // MRHCKM has no output file descriptor to block on
+    if (i_OutputFD < 0)
+    {
+        return UINT64_MAX;
+    }
+    
+    struct pollfd c_Output;
+    
+    c_Output.fd = i_OutputFD;
+    c_Output.events = POLLOUT;
+    c_Output.revents = 0;
+    
+    if (poll(&c_Output, 1, 0) <= 0 || (c_Output.revents & POLLOUT) == 0)
+    {
+        return 0;
+    }
+    
+    // A writable output has space for PIPE_BUF bytes, a pipe also for 
+    // all pages not used by unread bytes
+    MRH_Uint64 u64_Space = PIPE_BUF;
+    int i_Unread;
+    
+    if (u64_PipeSize > 0 && ioctl(i_OutputFD, FIONREAD, &i_Unread) == 0 && i_Unread >= 0)
+    {
+        // The partially read page is counted as used
+        MRH_Uint64 u64_Used = static_cast<MRH_Uint64>(i_Unread) + PIPE_BUF;
+        
+        if (u64_Used < u64_PipeSize && u64_PipeSize - u64_Used > u64_Space)
+        {
+            u64_Space = u64_PipeSize - u64_Used;
+        }
+    }
+    
+    return u64_Space;
+}
+
+MRH_Uint64 LibmrhevTransport::GetMaxSpace() const noexcept
+{
+    if (i_OutputFD < 0)
+    {
+        return UINT64_MAX;
+    }
+    else if (u64_PipeSize > 2 * PIPE_BUF)
+    {
+        return u64_PipeSize - PIPE_BUF;
+    }
+    
+    return PIPE_BUF;
+}
+
+//*************************************************************************************
+// Error
+//*************************************************************************************
+
+void LibmrhevTransport::CheckLibraryError() noexcept
+{
+    if (MRH_GetEventQueueError() != MRH_EV_Error_Type::MRH_EV_ERROR_NONE)
+    {
+        MRH_LOG_WARNING("libmrhev error while processing events: ",
+                        MRH_GetEventQueueErrorString(),
+                        " (",
+                        MRH_GetEventQueueErrorFile(),
+                        ": ",
+                        MRH_GetEventQueueErrorFileLine(),
+                        ")!");
+        MRH_ResetEventQueueError();
+    }
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool LibmrhevTransport::GetPending() const noexcept
+{
+    return MRH_CanSendEvents(p_OutputEventQueue) < 0 ? false : true;
+}
+
+int LibmrhevTransport::GetFD() const noexcept
+{
+    return i_OutputFD;
+}
+
+bool LibmrhevTransport::GetDoorbell() const noexcept
+{
+    return false;
+}
+
+bool LibmrhevTransport::GetRecycling() const noexcept
+{
+    return false;
+}
@@ -0,0 +1,188 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LibmrhevTransport_h
+#define LibmrhevTransport_h
+
+// C / C++
+
+// External
+#include <libmrhev.h>
+
+// Project
+#include "./EventTransport.h"
+
+
+class LibmrhevTransport : public EventTransport
+{
+public:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param e_Type The transport type, either pipe or MRHCKM.
+     *  \param p_Output The pipe output file descriptor or the MRHCKM output given 
+     *                  as "<device path>,<key>".
+     *  \param p_EventLimit The max amount of event to be sent in a update.
+     */
+    
+    LibmrhevTransport(Type e_Type,
+                      const char* p_Output,
+                      const char* p_EventLimit);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_LibmrhevTransport LibmrhevTransport class source.
+     */
+    
+    LibmrhevTransport(LibmrhevTransport const& c_LibmrhevTransport) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~LibmrhevTransport() noexcept;
+    
+    //*************************************************************************************
+    // Add
+    //*************************************************************************************
+    
+    /**
+     *  Add a event to the libmrhev queue.
+     *
+     *  \param p_Event The event to add. The event is consumed on success.
+     *
+     *  \return The add result.
+     */
+    
+    AddResult Add(MRH_Event*& p_Event) noexcept override;
+    
+    //*************************************************************************************
+    // Send
+    //*************************************************************************************
+    
+    /**
+     *  Send queued events if the output is writable. Events are only added 
+     *  while the output has space for them, the send never blocks.
+     */
+    
+    void Send() noexcept override;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Wait until the output can be written to.
+     *
+     *  \param i_TimeoutMS The max time to wait in milliseconds.
+     *
+     *  \return true if the output is writable, false if not.
+     */
+    
+    bool WaitWritable(int i_TimeoutMS) noexcept override;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get wether queued events wait to be sent or not.
+     *
+     *  \return true if events wait, false if not.
+     */
+    
+    bool GetPending() const noexcept override;
+    
+    /**
+     *  Get the output file descriptor.
+     *
+     *  \return The output file descriptor, -1 for MRHCKM.
+     */
+    
+    int GetFD() const noexcept override;
+    
+    /**
+     *  Check if the output file descriptor is a doorbell.
+     *
+     *  \return Always false.
+     */
+    
+    bool GetDoorbell() const noexcept override;
+    
+    /**
+     *  Check if events given to the transport are returned to the event pool.
+     *
+     *  \return Always false, libmrhev frees the events it sent.
+     */
+    
+    bool GetRecycling() const noexcept override;
+
+private:
+
+    //*************************************************************************************
+    // Space
+    //*************************************************************************************
+    
+    /**
+     *  Get the bytes which can be written to the output without blocking.
+     *
+     *  \return The free output space in bytes.
+     */
+    
+    MRH_Uint64 GetSpace() const noexcept;
+    
+    /**
+     *  Get the bytes which can be written to the empty output without blocking.
+     *
+     *  \return The max output space in bytes.
+     */
+    
+    MRH_Uint64 GetMaxSpace() const noexcept;
+    
+    //*************************************************************************************
+    // Error
+    //*************************************************************************************
+    
+    /**
+     *  Check libmrhev for errors.
+     */
+    
+    void CheckLibraryError() noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    MRH_OutputEventQueue* p_OutputEventQueue;
+    int i_OutputFD;
+    
+    // Pipe size, 0 if unknown
+    MRH_Uint64 u64_PipeSize;
+    
+    // Bytes the next send can write without blocking
+    MRH_Uint64 u64_SendSpace;
+
+protected:
+
+};
+
+#endif /* LibmrhevTransport_h */
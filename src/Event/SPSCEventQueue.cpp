@@ -0,0 +1,117 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+
+// External
+
+// Project
+#include "./SPSCEventQueue.h"
+#include "./EventPool.h"
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+SPSCEventQueue::SPSCEventQueue(size_t us_Capacity) : us_Head(0),
+                                                     us_Tail(0)
+{
+    size_t us_Size = 2;
+    
+    while (us_Size < us_Capacity)
+    {
+        us_Size <<= 1;
+    }
+    
+    v_Event.resize(us_Size, NULL);
+    us_Mask = us_Size - 1;
+}
+
+SPSCEventQueue::~SPSCEventQueue() noexcept
+{
+    MRH_Event* p_Event;
+    
+    while (Pop(&p_Event, 1) > 0)
+    {
+        EventPool::Singleton().Release(p_Event);
+    }
+}
+
+//*************************************************************************************
+// Push
+//*************************************************************************************
+
+size_t SPSCEventQueue::Push(MRH_Event** p_Event, size_t us_Count) noexcept
+{
+    size_t us_Tail = this->us_Tail.load(std::memory_order_relaxed);
+    size_t us_Free = v_Event.size() - (us_Tail - us_Head.load(std::memory_order_acquire));
+    
+    if (us_Count > us_Free)
+    {
+        us_Count = us_Free;
+    }
+    
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        v_Event[(us_Tail + i) & us_Mask] = p_Event[i];
+        p_Event[i] = NULL;
+    }
+    
+    // Publish the written events to the consumer
+    this->us_Tail.store(us_Tail + us_Count, std::memory_order_release);
+    
+    return us_Count;
+}
+
+//*************************************************************************************
+// Pop
+//*************************************************************************************
+
+size_t SPSCEventQueue::Pop(MRH_Event** p_Event, size_t us_Count) noexcept
+{
+    size_t us_Head = this->us_Head.load(std::memory_order_relaxed);
+    size_t us_Available = us_Tail.load(std::memory_order_acquire) - us_Head;
+    
+    if (us_Count > us_Available)
+    {
+        us_Count = us_Available;
+    }
+    
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        p_Event[i] = v_Event[(us_Head + i) & us_Mask];
+    }
+    
+    // Hand the read slots back to the producer
+    this->us_Head.store(us_Head + us_Count, std::memory_order_release);
+    
+    return us_Count;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+size_t SPSCEventQueue::GetFreeCount() const noexcept
+{
+    return v_Event.size() - (us_Tail.load(std::memory_order_relaxed) - us_Head.load(std::memory_order_acquire));
+}
+
+size_t SPSCEventQueue::GetEventCount() const noexcept
+{
+    return us_Tail.load(std::memory_order_acquire) - us_Head.load(std::memory_order_acquire);
+}
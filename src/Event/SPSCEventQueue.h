@@ -0,0 +1,134 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SPSCEventQueue_h
+#define SPSCEventQueue_h
+
+// C / C++
+#include <cstddef>
+#include <atomic>
+#include <vector>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+
+
+class SPSCEventQueue
+{
+public:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param us_Capacity The minimum amount of events the queue can hold. The
+     *                     capacity is rounded up to the next power of two.
+     */
+    
+    SPSCEventQueue(size_t us_Capacity);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_SPSCEventQueue SPSCEventQueue class source.
+     */
+    
+    SPSCEventQueue(SPSCEventQueue const& c_SPSCEventQueue) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~SPSCEventQueue() noexcept;
+    
+    //*************************************************************************************
+    // Push
+    //*************************************************************************************
+    
+    /**
+     *  Add events to the queue. Only the producer thread may call this function.
+     *
+     *  \param p_Event The events to add. Added events are consumed.
+     *  \param us_Count The amount of events to add.
+     *
+     *  \return The amount of events added.
+     */
+    
+    size_t Push(MRH_Event** p_Event, size_t us_Count) noexcept;
+    
+    //*************************************************************************************
+    // Pop
+    //*************************************************************************************
+    
+    /**
+     *  Remove events from the queue. Only the consumer thread may call this function.
+     *
+     *  \param p_Event The buffer to write the events to.
+     *  \param us_Count The max amount of events to write.
+     *
+     *  \return The amount of events written to the buffer.
+     */
+    
+    size_t Pop(MRH_Event** p_Event, size_t us_Count) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the amount of events which can be added. Only the producer thread may
+     *  call this function.
+     *
+     *  \return The amount of free event slots.
+     */
+    
+    size_t GetFreeCount() const noexcept;
+    
+    /**
+     *  Get the amount of events in the queue.
+     *
+     *  \return The amount of events in the queue.
+     */
+    
+    size_t GetEventCount() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Storage
+    std::vector<MRH_Event*> v_Event;
+    size_t us_Mask;
+    
+    // Keep both positions on their own cache line
+    char p_HeadPadding[64];
+    std::atomic<size_t> us_Head; // Consumer position
+    char p_TailPadding[64];
+    std::atomic<size_t> us_Tail; // Producer position
+    char p_EndPadding[64];
+
+protected:
+
+};
+
+#endif /* SPSCEventQueue_h */
@@ -0,0 +1,290 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+// External
+
+// Project
+#include "./SharedMemoryEventQueue.h"
+
+// Pre-defined
+namespace
+{
+    // Ring identification
+    const char p_Magic[8] = { 'M', 'R', 'H', 'E', 'V', 'S', 'H', 'M' };
+    constexpr MRH_Uint32 u32_Version = 2;
+    
+    // Event data starts on the page after the header
+    constexpr size_t us_DataOffset = 4096;
+    
+    // Records are aligned for in-place reads
+    constexpr MRH_Uint64 u64_RecordAlign = sizeof(SharedMemoryEventQueue::Record);
+    
+    // Record data size filling the ring end before a wrap, every type is a 
+    // valid event type but no record can hold this much data
+    constexpr MRH_Uint32 u32_SkipDataSize = 0xFFFFFFFF;
+    
+    static_assert(sizeof(SharedMemoryEventQueue::Header) == 192, "Invalid shared memory header layout!");
+    static_assert(sizeof(SharedMemoryEventQueue::Record) == 16, "Invalid shared memory record layout!");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "Shared memory positions have to be lock free!");
+    
+    // Close a descriptor once, negative descriptors are ignored
+    void CloseDescriptor(int& i_FD) noexcept
+    {
+        if (i_FD >= 0)
+        {
+            close(i_FD);
+            i_FD = -1;
+        }
+    }
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+SharedMemoryEventQueue::SharedMemoryEventQueue(const char* p_Descriptor) : p_Header(NULL),
+                                                                           p_Data(NULL),
+                                                                           us_MapSize(0),
+                                                                           u64_Mask(0),
+                                                                           u64_Tail(0),
+                                                                           i_DataFD(-1),
+                                                                           i_SpaceFD(-1)
+{
+    int i_MemFD = -1;
+    
+    // The destructor does not run on failure, close the handed over descriptors
+    try
+    {
+        if (p_Descriptor == NULL || std::sscanf(p_Descriptor, "%d,%d,%d", &i_MemFD, &i_DataFD, &i_SpaceFD) != 3 ||
+            i_MemFD < 0 || i_DataFD < 0 || i_SpaceFD < 0)
+        {
+            throw Exception("Invalid shared memory descriptor recieved!");
+        }
+        
+        // Map the ring, the parent created and sized it
+        struct stat c_Stat;
+        
+        if (fstat(i_MemFD, &c_Stat) < 0)
+        {
+            throw Exception("Failed to get shared memory size: " + std::string(std::strerror(errno)) + "!");
+        }
+        
+        MRH_Uint64 u64_Capacity = static_cast<MRH_Uint64>(c_Stat.st_size) - us_DataOffset;
+        
+        if (static_cast<size_t>(c_Stat.st_size) <= us_DataOffset || (u64_Capacity & (u64_Capacity - 1)) != 0)
+        {
+            throw Exception("Invalid shared memory size!");
+        }
+        
+        void* p_Map = mmap(NULL, c_Stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, i_MemFD, 0);
+        
+        if (p_Map == MAP_FAILED)
+        {
+            throw Exception("Failed to map shared memory: " + std::string(std::strerror(errno)) + "!");
+        }
+        
+        // The mapping keeps the memory alive
+        CloseDescriptor(i_MemFD);
+        
+        p_Header = static_cast<Header*>(p_Map);
+        us_MapSize = c_Stat.st_size;
+        
+        if (std::memcmp(p_Header->p_Magic, p_Magic, sizeof(p_Magic)) != 0 ||
+            p_Header->u32_Version != u32_Version ||
+            p_Header->u64_Capacity != u64_Capacity)
+        {
+            munmap(p_Map, us_MapSize);
+            p_Header = NULL;
+            
+            throw Exception("Invalid shared memory header!");
+        }
+        
+        p_Data = static_cast<MRH_Uint8*>(p_Map) + us_DataOffset;
+        u64_Mask = u64_Capacity - 1;
+        u64_Tail = p_Header->u64_Tail.load(std::memory_order_relaxed);
+    }
+    catch (...)
+    {
+        CloseDescriptor(i_MemFD);
+        CloseDescriptor(i_DataFD);
+        CloseDescriptor(i_SpaceFD);
+        
+        throw;
+    }
+}
+
+SharedMemoryEventQueue::~SharedMemoryEventQueue() noexcept
+{
+    if (p_Header != NULL)
+    {
+        Publish();
+        munmap(p_Header, us_MapSize);
+    }
+    
+    close(i_DataFD);
+    close(i_SpaceFD);
+}
+
+//*************************************************************************************
+// Write
+//*************************************************************************************
+
+SharedMemoryEventQueue::WriteResult SharedMemoryEventQueue::Write(MRH_Event const* p_Event) noexcept
+{
+    // Records never exceed half the ring, a wrap always fits after a full read
+    MRH_Uint64 u64_Capacity = u64_Mask + 1;
+    MRH_Uint64 u64_Size = (sizeof(Record) + p_Event->u32_DataSize + u64_RecordAlign - 1) & ~(u64_RecordAlign - 1);
+    
+    if (u64_Size > u64_Capacity / 2 || (p_Event->u32_DataSize > 0 && p_Event->p_Data == NULL))
+    {
+        return WRITE_INVALID;
+    }
+    
+    MRH_Uint64 u64_Position = u64_Tail & u64_Mask;
+    MRH_Uint64 u64_Skip = u64_Capacity - u64_Position < u64_Size ? u64_Capacity - u64_Position : 0;
+    
+    if (u64_Tail + u64_Skip + u64_Size - p_Header->u64_Head.load(std::memory_order_acquire) > u64_Capacity)
+    {
+        // Request the space doorbell, the reader might have read in between
+        p_Header->u32_WriterWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        
+        if (u64_Tail + u64_Skip + u64_Size - p_Header->u64_Head.load(std::memory_order_acquire) > u64_Capacity)
+        {
+            return WRITE_FULL;
+        }
+    }
+    
+    // Fill the ring end, the record is written from the start
+    if (u64_Skip > 0)
+    {
+        Record* p_Skip = reinterpret_cast<Record*>(p_Data + u64_Position);
+        
+        p_Skip->u32_Type = 0;
+        p_Skip->u32_GroupID = 0;
+        p_Skip->u32_DataSize = u32_SkipDataSize;
+        p_Skip->u32_Size = static_cast<MRH_Uint32>(u64_Skip);
+        
+        u64_Tail += u64_Skip;
+        u64_Position = 0;
+    }
+    
+    Record* p_Record = reinterpret_cast<Record*>(p_Data + u64_Position);
+    
+    p_Record->u32_Type = p_Event->u32_Type;
+    p_Record->u32_GroupID = p_Event->u32_GroupID;
+    p_Record->u32_DataSize = p_Event->u32_DataSize;
+    p_Record->u32_Size = static_cast<MRH_Uint32>(u64_Size);
+    
+    if (p_Event->u32_DataSize > 0)
+    {
+        std::memcpy(p_Record + 1, p_Event->p_Data, p_Event->u32_DataSize);
+    }
+    
+    u64_Tail += u64_Size;
+    
+    return WRITE_OK;
+}
+
+bool SharedMemoryEventQueue::Publish() noexcept
+{
+    if (p_Header->u64_Tail.load(std::memory_order_relaxed) == u64_Tail)
+    {
+        return false;
+    }
+    
+    p_Header->u64_Tail.store(u64_Tail, std::memory_order_release);
+    
+    // Only ring for a sleeping reader, the reader rechecks after requesting it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    if (p_Header->u32_ReaderWaiting.load(std::memory_order_relaxed) != 0 &&
+        p_Header->u32_ReaderWaiting.exchange(0, std::memory_order_relaxed) != 0)
+    {
+        uint64_t u64_Value = 1;
+        
+        // A full counter means a wake up is pending anyway
+        if (write(i_DataFD, &u64_Value, sizeof(u64_Value)) < 0)
+        {}
+    }
+    
+    return true;
+}
+
+//*************************************************************************************
+// Wait
+//*************************************************************************************
+
+bool SharedMemoryEventQueue::WaitSpace(int i_TimeoutMS) noexcept
+{
+    struct pollfd c_Space;
+    
+    c_Space.fd = i_SpaceFD;
+    c_Space.events = POLLIN;
+    c_Space.revents = 0;
+    
+    // No write failed or the reader answered already, clear a late doorbell 
+    // since we are the only one reading it
+    if (p_Header->u32_WriterWaiting.load(std::memory_order_acquire) == 0)
+    {
+        if (poll(&c_Space, 1, 0) > 0)
+        {
+            uint64_t u64_Value;
+            
+            if (read(i_SpaceFD, &u64_Value, sizeof(u64_Value)) < 0)
+            {}
+        }
+        
+        return true;
+    }
+    
+    if (poll(&c_Space, 1, i_TimeoutMS) <= 0)
+    {
+        return false;
+    }
+    
+    uint64_t u64_Value;
+    
+    if (read(i_SpaceFD, &u64_Value, sizeof(u64_Value)) < 0)
+    {}
+    
+    return true;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+int SharedMemoryEventQueue::GetSpaceFD() const noexcept
+{
+    return i_SpaceFD;
+}
+
+size_t SharedMemoryEventQueue::GetUsedSize() const noexcept
+{
+    return static_cast<size_t>(u64_Tail - p_Header->u64_Head.load(std::memory_order_acquire));
+}
@@ -0,0 +1,184 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SharedMemoryEventQueue_h
+#define SharedMemoryEventQueue_h
+
+// C / C++
+#include <cstddef>
+#include <atomic>
+
+// External
+#include <MRH_Event.h>
+
+// Project
+#include "../Exception.h"
+
+
+class SharedMemoryEventQueue
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        WRITE_OK = 0,
+        WRITE_FULL = 1,
+        WRITE_INVALID = 2,
+        
+        WRITE_RESULT_MAX = WRITE_INVALID,
+        
+        WRITE_RESULT_COUNT = WRITE_RESULT_MAX + 1
+    
+    }WriteResult;
+    
+    // @NOTE: Shared with the reading parent, the layout is fixed
+    struct Header
+    {
+        char p_Magic[8];
+        MRH_Uint32 u32_Version;
+        MRH_Uint32 u32_Reserved;
+        MRH_Uint64 u64_Capacity;
+        char p_HeadPadding[40];
+        std::atomic<MRH_Uint64> u64_Head; // Reader position
+        std::atomic<MRH_Uint32> u32_WriterWaiting;
+        char p_TailPadding[52];
+        std::atomic<MRH_Uint64> u64_Tail; // Writer position
+        std::atomic<MRH_Uint32> u32_ReaderWaiting;
+        char p_EndPadding[52];
+    };
+    
+    struct Record
+    {
+        MRH_Uint32 u32_Type;
+        MRH_Uint32 u32_GroupID;
+        MRH_Uint32 u32_DataSize;
+        MRH_Uint32 u32_Size; // Record size including the header and padding
+    };
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param p_Descriptor The shared memory descriptor, given as 
+     *                      "<memfd>,<data eventfd>,<space eventfd>".
+     */
+    
+    SharedMemoryEventQueue(const char* p_Descriptor);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_SharedMemoryEventQueue SharedMemoryEventQueue class source.
+     */
+    
+    SharedMemoryEventQueue(SharedMemoryEventQueue const& c_SharedMemoryEventQueue) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~SharedMemoryEventQueue() noexcept;
+    
+    //*************************************************************************************
+    // Write
+    //*************************************************************************************
+    
+    /**
+     *  Copy a event to the ring. Written events are seen by the reader after 
+     *  publishing them.
+     *
+     *  \param p_Event The event to write. The event is not consumed.
+     *
+     *  \return The write result.
+     */
+    
+    WriteResult Write(MRH_Event const* p_Event) noexcept;
+    
+    /**
+     *  Publish all written events and wake the reader if it waits for data.
+     *
+     *  \return true if events were published, false if none were written.
+     */
+    
+    bool Publish() noexcept;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Wait until the reader made space after a write failed on a full ring. 
+     *  Written events have to be published first.
+     *
+     *  \param i_TimeoutMS The max time to wait in milliseconds.
+     *
+     *  \return true if writing should be retried, false if not.
+     */
+    
+    bool WaitSpace(int i_TimeoutMS) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the space doorbell file descriptor. The descriptor becomes readable once 
+     *  the reader made space for a waiting writer.
+     *
+     *  \return The space doorbell file descriptor.
+     */
+    
+    int GetSpaceFD() const noexcept;
+    
+    /**
+     *  Get the amount of written but unread bytes.
+     *
+     *  \return The used ring size in bytes.
+     */
+    
+    size_t GetUsedSize() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Mapping
+    Header* p_Header;
+    MRH_Uint8* p_Data;
+    size_t us_MapSize;
+    MRH_Uint64 u64_Mask;
+    
+    // Unpublished writer position
+    MRH_Uint64 u64_Tail;
+    
+    // Doorbells
+    int i_DataFD;
+    int i_SpaceFD;
+
+protected:
+
+};
+
+#endif /* SharedMemoryEventQueue_h */
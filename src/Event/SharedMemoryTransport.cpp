@@ -0,0 +1,106 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+
+// External
+
+// Project
+#include "./SharedMemoryTransport.h"
+#include "./EventPool.h"
+#include "../Metrics.h"
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+SharedMemoryTransport::SharedMemoryTransport(const char* p_Output) : EventTransport(TRANSPORT_SHARED_MEMORY),
+                                                                     c_Queue(p_Output)
+{}
+
+SharedMemoryTransport::~SharedMemoryTransport() noexcept
+{}
+
+//*************************************************************************************
+// Add
+//*************************************************************************************
+
+EventTransport::AddResult SharedMemoryTransport::Add(MRH_Event*& p_Event) noexcept
+{
+    switch (c_Queue.Write(p_Event))
+    {
+        case SharedMemoryEventQueue::WRITE_OK:
+            // The ring holds a copy, the event itself is done
+            RecordAdded(p_Event->u32_DataSize);
+            EventPool::Singleton().Release(p_Event);
+            return ADD_OK;
+        
+        case SharedMemoryEventQueue::WRITE_FULL:
+            RecordFull();
+            return ADD_FULL;
+        
+        default:
+            return ADD_INVALID;
+    }
+}
+
+//*************************************************************************************
+// Send
+//*************************************************************************************
+
+void SharedMemoryTransport::Send() noexcept
+{
+    MRH_Uint64 u64_Start = Metrics::GetTimeNS();
+    
+    if (c_Queue.Publish() == true)
+    {
+        RecordSend(Metrics::GetTimeNS() - u64_Start);
+    }
+}
+
+//*************************************************************************************
+// Wait
+//*************************************************************************************
+
+bool SharedMemoryTransport::WaitWritable(int i_TimeoutMS) noexcept
+{
+    return c_Queue.WaitSpace(i_TimeoutMS);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool SharedMemoryTransport::GetPending() const noexcept
+{
+    return false;
+}
+
+int SharedMemoryTransport::GetFD() const noexcept
+{
+    return c_Queue.GetSpaceFD();
+}
+
+bool SharedMemoryTransport::GetDoorbell() const noexcept
+{
+    return true;
+}
+
+bool SharedMemoryTransport::GetRecycling() const noexcept
+{
+    return true;
+}
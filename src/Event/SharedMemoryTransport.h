@@ -0,0 +1,146 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SharedMemoryTransport_h
+#define SharedMemoryTransport_h
+
+// C / C++
+
+// External
+
+// Project
+#include "./EventTransport.h"
+#include "./SharedMemoryEventQueue.h"
+
+
+class SharedMemoryTransport : public EventTransport
+{
+public:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param p_Output The shared memory descriptor, given as 
+     *                  "<memfd>,<data eventfd>,<space eventfd>".
+     */
+    
+    SharedMemoryTransport(const char* p_Output);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_SharedMemoryTransport SharedMemoryTransport class source.
+     */
+    
+    SharedMemoryTransport(SharedMemoryTransport const& c_SharedMemoryTransport) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~SharedMemoryTransport() noexcept;
+    
+    //*************************************************************************************
+    // Add
+    //*************************************************************************************
+    
+    /**
+     *  Copy a event to the ring. The event is returned to the event pool.
+     *
+     *  \param p_Event The event to add. The event is consumed on success.
+     *
+     *  \return The add result.
+     */
+    
+    AddResult Add(MRH_Event*& p_Event) noexcept override;
+    
+    //*************************************************************************************
+    // Send
+    //*************************************************************************************
+    
+    /**
+     *  Publish the events copied to the ring.
+     */
+    
+    void Send() noexcept override;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Wait until the reader made space after a add failed on a full ring.
+     *
+     *  \param i_TimeoutMS The max time to wait in milliseconds.
+     *
+     *  \return true if adding should be retried, false if not.
+     */
+    
+    bool WaitWritable(int i_TimeoutMS) noexcept override;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get wether added events wait to be sent or not.
+     *
+     *  \return Always false, added events are sent once published.
+     */
+    
+    bool GetPending() const noexcept override;
+    
+    /**
+     *  Get the space doorbell file descriptor.
+     *
+     *  \return The space doorbell file descriptor.
+     */
+    
+    int GetFD() const noexcept override;
+    
+    /**
+     *  Check if the output file descriptor is a doorbell.
+     *
+     *  \return Always true.
+     */
+    
+    bool GetDoorbell() const noexcept override;
+    
+    /**
+     *  Check if events given to the transport are returned to the event pool.
+     *
+     *  \return Always true.
+     */
+    
+    bool GetRecycling() const noexcept override;
+
+private:
+
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    SharedMemoryEventQueue c_Queue;
+
+protected:
+
+};
+
+#endif /* SharedMemoryTransport_h */
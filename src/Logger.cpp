@@ -17,9 +17,17 @@
 // C / C++
 #include <execinfo.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <iostream>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
 
 // External
 
@@ -33,28 +41,115 @@
 #ifndef MRH_USERVICE_BACKTRACE_FILE_PATH_BASE
     #define MRH_USERVICE_BACKTRACE_FILE_PATH_BASE "/var/log/mrh/mrhuservice/bt_mrhuservice_"
 #endif
+#ifndef MRH_USERVICE_MINIDUMP_FILE_PATH_BASE
+    #define MRH_USERVICE_MINIDUMP_FILE_PATH_BASE "/var/log/mrh/mrhuservice/md_mrhuservice_"
+#endif
+#ifndef MRH_LOGGER_MINIDUMP
+    #define MRH_LOGGER_MINIDUMP 0
+#endif
 #ifndef MRH_LOGGER_PRINT_CLI
     #define MRH_LOGGER_PRINT_CLI 0
 #endif
+#ifndef MRH_LOGGER_ASYNC
+    #define MRH_LOGGER_ASYNC 1
+#endif
+#ifndef MRH_LOGGER_RING_SIZE
+    #define MRH_LOGGER_RING_SIZE 512 // Power of 2
+#endif
+#ifndef MRH_LOGGER_FLUSH_INTERVAL_MS
+    #define MRH_LOGGER_FLUSH_INTERVAL_MS 250
+#endif
+#ifndef MRH_LOGGER_BACKPRESSURE_RETRY
+    #define MRH_LOGGER_BACKPRESSURE_RETRY 64
+#endif
+
+namespace
+{
+    // Record ring
+    constexpr size_t us_RecordMask = MRH_LOGGER_RING_SIZE - 1;
+    
+    static_assert((MRH_LOGGER_RING_SIZE & us_RecordMask) == 0, "Logger ring size has to be a power of 2!");
+    
+    // Records written with a single writev() call
+    constexpr int i_FlushBatch = 64;
+    
+    // Minidump record head, followed by the frame addresses as 64 bit values 
+    // and the /proc/self/maps text
+    constexpr uint32_t MINIDUMP_VERSION = 1;
+    
+    struct MinidumpHeader
+    {
+        char p_Magic[4]; // "MRHD"
+        uint32_t u32_Version;
+        int32_t s32_Signal;
+        int32_t s32_PID;
+        int64_t s64_Time; // Unix time in seconds
+        uint32_t u32_FrameCount;
+        uint32_t u32_Reserved;
+    };
+}
 
 
 //*************************************************************************************
 // Constructor / Destructor
 //*************************************************************************************
 
-Logger::Logger() noexcept
-{}
+Logger::Logger() noexcept : i_LogFD(-1),
+                            i_BacktraceFD(-1),
+                            i_MinidumpFD(-1),
+                            p_Record(NULL),
+                            us_RecordTail(0),
+                            us_RecordHead(0),
+                            us_Dropped(0),
+                            b_FlusherRun(false),
+                            i_WakeFD(-1)
+{
+#if MRH_LOGGER_ASYNC > 0
+    // Preallocate all records, logging itself never allocates
+    p_Record = new (std::nothrow) LogRecord[MRH_LOGGER_RING_SIZE];
+    
+    if (p_Record != NULL)
+    {
+        for (size_t i = 0; i < MRH_LOGGER_RING_SIZE; ++i)
+        {
+            p_Record[i].us_Sequence.store(i, std::memory_order_relaxed);
+            p_Record[i].us_Length = 0;
+        }
+    }
+    
+    i_WakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
 
 Logger::~Logger() noexcept
 {
-    if (f_LogFile.is_open() == true)
+    // Stop the flusher first, the remaining records are written after
+    if (c_Flusher.joinable() == true)
+    {
+        b_FlusherRun = false;
+        RequestFlush();
+        c_Flusher.join();
+    }
+    
+    if (p_Record != NULL)
     {
-        f_LogFile.close();
+        while (FlushRecords() > 0)
+        {}
+        
+        delete[] p_Record;
     }
     
-    if (f_BacktraceFile.is_open() == true)
+    if (i_WakeFD >= 0)
     {
-        f_BacktraceFile.close();
+        close(i_WakeFD);
+    }
+    
+    for (int i_FD : { i_LogFD, i_BacktraceFD, i_MinidumpFD })
+    {
+        if (i_FD >= 0)
+        {
+            close(i_FD);
+        }
     }
 }
 
@@ -74,32 +169,68 @@ Logger& Logger::Singleton() noexcept
 
 void Logger::OpenFiles(std::string const& s_PackageName) noexcept
 {
-    if (f_LogFile.is_open() == true)
+    // Write everything queued for the old file first
+    if (c_Flusher.joinable() == true)
     {
-        f_LogFile.close();
+        b_FlusherRun = false;
+        RequestFlush();
+        c_Flusher.join();
     }
     
-    if (f_BacktraceFile.is_open() == true)
+    for (int* p_FD : { &i_LogFD, &i_BacktraceFD, &i_MinidumpFD })
     {
-        f_BacktraceFile.close();
+        if (*p_FD >= 0)
+        {
+            close(*p_FD);
+            *p_FD = -1;
+        }
     }
     
     std::string s_LogFilePath(MRH_USERVICE_LOG_FILE_PATH_BASE + s_PackageName + ".log");
     std::string s_BacktraceFilePath(MRH_USERVICE_BACKTRACE_FILE_PATH_BASE + s_PackageName + ".log");
+    std::string s_MinidumpFilePath(MRH_USERVICE_MINIDUMP_FILE_PATH_BASE + s_PackageName + ".dmp");
     
-    f_LogFile.open(s_LogFilePath, std::ios::out | std::ios::trunc);
-    f_BacktraceFile.open(s_BacktraceFilePath, std::ios::out | std::ios::trunc);
+    // Crash files are opened now, the signal handler only writes
+    i_LogFD = open(s_LogFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0666);
+    i_BacktraceFD = open(s_BacktraceFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0666);
+    
+    if (MRH_LOGGER_MINIDUMP > 0)
+    {
+        i_MinidumpFD = open(s_MinidumpFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0666);
+    }
+    
+    // The first backtrace() call loads libgcc which allocates, do it outside 
+    // of the signal handler
+    void* p_Frame[1];
+    backtrace(p_Frame, 1);
+    
+    // Synchronous logging if the ring is missing
+    if (p_Record != NULL && i_WakeFD >= 0)
+    {
+        try
+        {
+            b_FlusherRun = true;
+            c_Flusher = std::thread(Flusher, this);
+        }
+        catch (...)
+        {
+            b_FlusherRun = false;
+        }
+    }
     
-    if (f_LogFile.is_open() == false)
+    if (i_LogFD < 0)
     {
-        Log(Logger::WARNING, "Failed to open user service log file: " + s_LogFilePath,
-            "Logger.cpp", __LINE__);
+        MRH_LOG_WARNING("Failed to open user service log file: ", s_LogFilePath);
     }
     
-    if (f_BacktraceFile.is_open() == false)
+    if (i_BacktraceFD < 0)
     {
-        Log(Logger::WARNING, "Failed to open user service backtrace file: " + s_BacktraceFilePath,
-            "Logger.cpp", __LINE__);
+        MRH_LOG_WARNING("Failed to open user service backtrace file: ", s_BacktraceFilePath);
+    }
+    
+    if (MRH_LOGGER_MINIDUMP > 0 && i_MinidumpFD < 0)
+    {
+        MRH_LOG_WARNING("Failed to open user service minidump file: ", s_MinidumpFilePath);
     }
 }
 
@@ -109,69 +240,378 @@ void Logger::OpenFiles(std::string const& s_PackageName) noexcept
 
 void Logger::Log(LogLevel e_Level, std::string s_Message, std::string s_File, size_t us_Line) noexcept
 {
-    if (f_LogFile.is_open() == true)
+    Log(e_Level, s_Message.c_str(), s_Message.size(), s_File.c_str(), us_Line);
+}
+
+void Logger::Log(LogLevel e_Level, const char* p_Message, size_t us_MessageLength, const char* p_File, size_t us_Line) noexcept
+{
+    if (b_FlusherRun == false)
     {
-        f_LogFile << "[" << s_File << "][" << std::to_string(us_Line) << "][" << GetLevelString(e_Level) << "]: " << s_Message << std::endl;
+        // Logging happens from multiple threads
+        std::lock_guard<std::mutex> c_Guard(c_LogMutex);
+        
+        char p_Buffer[MRH_LOGGER_RECORD_SIZE];
+        struct iovec c_Line;
+        
+        c_Line.iov_base = p_Buffer;
+        c_Line.iov_len = Format(p_Buffer, sizeof(p_Buffer), e_Level, p_Message, us_MessageLength, p_File, us_Line);
+        
+        WriteLines(&c_Line, 1);
+        return;
     }
     
-    if (MRH_LOGGER_PRINT_CLI > 0)
+    // Claim a record, apply backpressure for a bounded time if the ring is full
+    size_t us_Position = us_RecordTail.load(std::memory_order_relaxed);
+    size_t us_Retry = 0;
+    LogRecord* p_Target;
+    
+    while (true)
+    {
+        p_Target = &(p_Record[us_Position & us_RecordMask]);
+        intptr_t i_Diff = static_cast<intptr_t>(p_Target->us_Sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(us_Position);
+        
+        if (i_Diff == 0)
+        {
+            if (us_RecordTail.compare_exchange_weak(us_Position, us_Position + 1, std::memory_order_relaxed) == true)
+            {
+                break;
+            }
+        }
+        else if (i_Diff < 0)
+        {
+            if (us_Retry++ >= MRH_LOGGER_BACKPRESSURE_RETRY)
+            {
+                us_Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            
+            RequestFlush();
+            sched_yield();
+            
+            us_Position = us_RecordTail.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            us_Position = us_RecordTail.load(std::memory_order_relaxed);
+        }
+    }
+    
+    p_Target->us_Length = Format(p_Target->p_Text, sizeof(p_Target->p_Text), e_Level, p_Message, us_MessageLength, p_File, us_Line);
+    p_Target->us_Sequence.store(us_Position + 1, std::memory_order_release);
+    
+    // Errors are written at once, otherwise wake each half ring
+    if (e_Level == ERROR || (us_Position & (us_RecordMask >> 1)) == 0)
     {
-        std::cout << "[" << s_File << "][" << std::to_string(us_Line) << "][" << GetLevelString(e_Level) << "]: " << s_Message << std::endl;
+        RequestFlush();
     }
 }
 
 //*************************************************************************************
-// Backtrace
+// Format
 //*************************************************************************************
 
-void Logger::Backtrace(size_t us_TraceSize, std::string s_Message) noexcept
+size_t Logger::Format(char* p_Buffer, size_t us_Size, LogLevel e_Level, const char* p_Message, size_t us_MessageLength, const char* p_File, size_t us_Line) noexcept
+{
+    // [File][Line][Level]: Message\n
+    size_t us_Length = 0;
+    
+    auto Append = [&](const char* p_String, size_t us_StringLength)
+    {
+        // Keep space for the line end
+        if (us_StringLength > us_Size - 1 - us_Length)
+        {
+            us_StringLength = us_Size - 1 - us_Length;
+        }
+        
+        std::memcpy(p_Buffer + us_Length, p_String, us_StringLength);
+        us_Length += us_StringLength;
+    };
+    
+    char p_Line[24];
+    size_t us_LineLength = sizeof(p_Line);
+    
+    do
+    {
+        p_Line[--us_LineLength] = '0' + (us_Line % 10);
+        us_Line /= 10;
+    }
+    while (us_Line > 0 && us_LineLength > 0);
+    
+    const char* p_Level = GetLevelString(e_Level);
+    
+    Append("[", 1);
+    Append(p_File, std::strlen(p_File));
+    Append("][", 2);
+    Append(p_Line + us_LineLength, sizeof(p_Line) - us_LineLength);
+    Append("][", 2);
+    Append(p_Level, std::strlen(p_Level));
+    Append("]: ", 3);
+    Append(p_Message, us_MessageLength);
+    
+    p_Buffer[us_Length++] = '\n';
+    
+    return us_Length;
+}
+
+//*************************************************************************************
+// Flush
+//*************************************************************************************
+
+void Logger::RequestFlush() noexcept
+{
+    uint64_t u64_Value = 1;
+    
+    if (i_WakeFD >= 0 && write(i_WakeFD, &u64_Value, sizeof(u64_Value)) < 0)
+    {}
+}
+
+void Logger::FlushEmergency() noexcept
 {
-    if (f_BacktraceFile.is_open() == false)
+    if (p_Record == NULL)
     {
         return;
     }
     
-    // Retrieve current stack addresses
-    char** p_Traceback = NULL;
-    void* p_AdressList[us_TraceSize];
+    // @NOTE: The flusher thread might be writing the same records, 
+    //        a duplicate line is better than a lost one
+    size_t us_Position = us_RecordHead;
+    
+    for (size_t i = 0; i < MRH_LOGGER_RING_SIZE; ++i, ++us_Position)
+    {
+        LogRecord& c_Record = p_Record[us_Position & us_RecordMask];
+        
+        if (c_Record.us_Sequence.load(std::memory_order_acquire) != us_Position + 1)
+        {
+            break;
+        }
+        
+        struct iovec c_Line;
+        c_Line.iov_base = c_Record.p_Text;
+        c_Line.iov_len = c_Record.us_Length;
+        
+        WriteLines(&c_Line, 1);
+    }
+}
+
+void Logger::Flusher(Logger* p_Instance) noexcept
+{
+    struct pollfd c_Wake;
+    uint64_t u64_Value;
+    
+    c_Wake.fd = p_Instance->i_WakeFD;
+    c_Wake.events = POLLIN;
+    
+    while (p_Instance->b_FlusherRun == true)
+    {
+        if (poll(&c_Wake, 1, MRH_LOGGER_FLUSH_INTERVAL_MS) > 0 && read(p_Instance->i_WakeFD, &u64_Value, sizeof(u64_Value)) < 0)
+        {}
+        
+        while (p_Instance->FlushRecords() > 0)
+        {}
+    }
+    
+    // Written by the caller after the thread stopped
+}
+
+size_t Logger::FlushRecords() noexcept
+{
+    struct iovec p_Line[i_FlushBatch + 1];
+    int i_Count = 0;
+    
+    // Collect all published records in order
+    while (i_Count < i_FlushBatch)
+    {
+        LogRecord& c_Record = p_Record[(us_RecordHead + i_Count) & us_RecordMask];
+        
+        if (c_Record.us_Sequence.load(std::memory_order_acquire) != us_RecordHead + i_Count + 1)
+        {
+            break;
+        }
+        
+        p_Line[i_Count].iov_base = c_Record.p_Text;
+        p_Line[i_Count].iov_len = c_Record.us_Length;
+        ++i_Count;
+    }
+    
+    // Report dropped messages once after the batch
+    char p_Dropped[MRH_LOGGER_RECORD_SIZE];
+    size_t us_Dropped = this->us_Dropped.exchange(0, std::memory_order_relaxed);
     
-    us_TraceSize = backtrace(p_AdressList, (int)(sizeof(p_AdressList) / sizeof(void*)));
+    if (us_Dropped > 0)
+    {
+        std::string s_Message = "Dropped " + std::to_string(us_Dropped) + " log messages, log ring full!";
+        
+        p_Line[i_Count].iov_base = p_Dropped;
+        p_Line[i_Count].iov_len = Format(p_Dropped, sizeof(p_Dropped), WARNING, s_Message.c_str(), s_Message.size(), "Logger.cpp", __LINE__);
+        
+        WriteLines(p_Line, i_Count + 1);
+    }
+    else if (i_Count > 0)
+    {
+        WriteLines(p_Line, i_Count);
+    }
     
-    // Get names
-    if (us_TraceSize > 0)
+    // Hand the records back to the producers
+    for (int i = 0; i < i_Count; ++i, ++us_RecordHead)
+    {
+        p_Record[us_RecordHead & us_RecordMask].us_Sequence.store(us_RecordHead + MRH_LOGGER_RING_SIZE, std::memory_order_release);
+    }
+    
+    return static_cast<size_t>(i_Count);
+}
+
+void Logger::WriteLines(struct iovec* p_Buffer, int i_Count) noexcept
+{
+    if (i_LogFD >= 0)
     {
-        p_Traceback = backtrace_symbols(p_AdressList, (int)us_TraceSize);
+        ssize_t ss_Written;
+        
+        // Continue partial writes, drop the rest on error
+        while (i_Count > 0 && (ss_Written = writev(i_LogFD, p_Buffer, i_Count)) > 0)
+        {
+            while (i_Count > 0 && static_cast<size_t>(ss_Written) >= p_Buffer->iov_len)
+            {
+                ss_Written -= p_Buffer->iov_len;
+                ++p_Buffer;
+                --i_Count;
+            }
+            
+            if (i_Count > 0)
+            {
+                p_Buffer->iov_base = static_cast<char*>(p_Buffer->iov_base) + ss_Written;
+                p_Buffer->iov_len -= ss_Written;
+            }
+        }
     }
     
+    if (MRH_LOGGER_PRINT_CLI > 0 && i_Count > 0)
+    {
+        if (writev(STDOUT_FILENO, p_Buffer, i_Count) < 0)
+        {}
+    }
+}
+
+//*************************************************************************************
+// Backtrace
+//*************************************************************************************
+
+void Logger::Backtrace(int i_Signal) noexcept
+{
+    // @NOTE: Called from a signal handler, no allocations, no locks, 
+    //        no streams
+    void* p_Frame[MRH_LOGGER_BACKTRACE_SIZE];
+    int i_FrameCount = backtrace(p_Frame, MRH_LOGGER_BACKTRACE_SIZE);
+    
+    WriteStack("Caught Signal: ", i_Signal, p_Frame, i_FrameCount);
+    
+    if (i_FrameCount > 0 && i_MinidumpFD >= 0)
+    {
+        WriteMinidump(i_Signal, p_Frame, i_FrameCount);
+    }
+}
+
+void Logger::StackSample() noexcept
+{
+    void* p_Frame[MRH_LOGGER_BACKTRACE_SIZE];
+    int i_FrameCount = backtrace(p_Frame, MRH_LOGGER_BACKTRACE_SIZE);
+    
+    WriteStack("Stack Sample, Thread: ", syscall(SYS_gettid), p_Frame, i_FrameCount);
+}
+
+void Logger::WriteStack(const char* p_Title, long i_Value, void** p_Frame, int i_FrameCount) noexcept
+{
     // File head
-    WriteBacktrace(f_BacktraceFile, "====================================");
-    WriteBacktrace(f_BacktraceFile, "= " + s_Message);
-    WriteBacktrace(f_BacktraceFile, "====================================");
+    char p_Head[MRH_LOGGER_RECORD_SIZE];
+    size_t us_Length = 0;
+    
+    Append(p_Head, us_Length, "====================================\n= ");
+    Append(p_Head, us_Length, p_Title);
+    Append(p_Head, us_Length, i_Value);
+    Append(p_Head, us_Length, "\n====================================\n");
+    
+    if (i_FrameCount <= 0)
+    {
+        Append(p_Head, us_Length, "Failed to get traceback!\n");
+    }
     
     // Print traceback stack
-    if (us_TraceSize == 0)
+    WriteRaw(i_BacktraceFD, p_Head, us_Length);
+    
+    if (i_FrameCount > 0 && i_BacktraceFD >= 0)
     {
-        WriteBacktrace(f_BacktraceFile, "Failed to get traceback!");
+        backtrace_symbols_fd(p_Frame, i_FrameCount, i_BacktraceFD);
     }
-    else
+    
+    if (MRH_LOGGER_PRINT_CLI > 0)
     {
-        for (int i = 0; i < us_TraceSize && p_Traceback[i] != NULL; ++i)
+        WriteRaw(STDOUT_FILENO, p_Head, us_Length);
+        
+        if (i_FrameCount > 0)
         {
-            WriteBacktrace(f_BacktraceFile, std::string(p_Traceback[i]));
+            backtrace_symbols_fd(p_Frame, i_FrameCount, STDOUT_FILENO);
         }
     }
 }
 
-void Logger::WriteBacktrace(std::ofstream& f_File, std::string s_Message) noexcept
+void Logger::WriteMinidump(int i_Signal, void** p_Frame, int i_FrameCount) noexcept
 {
-    if (f_File.is_open() == true)
+    // Record: Header, frame addresses, /proc/self/maps until end of file
+    MinidumpHeader c_Header;
+    struct timespec c_Time;
+    
+    std::memset(&c_Header, 0, sizeof(c_Header));
+    std::memcpy(c_Header.p_Magic, "MRHD", sizeof(c_Header.p_Magic));
+    c_Header.u32_Version = MINIDUMP_VERSION;
+    c_Header.s32_Signal = i_Signal;
+    c_Header.s32_PID = getpid();
+    c_Header.u32_FrameCount = static_cast<uint32_t>(i_FrameCount);
+    
+    if (clock_gettime(CLOCK_REALTIME, &c_Time) == 0)
     {
-        f_File << s_Message << std::endl;
+        c_Header.s64_Time = c_Time.tv_sec;
     }
     
-    if (MRH_LOGGER_PRINT_CLI > 0)
+    WriteRaw(i_MinidumpFD, &c_Header, sizeof(c_Header));
+    
+    for (int i = 0; i < i_FrameCount; ++i)
+    {
+        uint64_t u64_Address = reinterpret_cast<uintptr_t>(p_Frame[i]);
+        WriteRaw(i_MinidumpFD, &u64_Address, sizeof(u64_Address));
+    }
+    
+    // Module mappings, needed to resolve the addresses offline
+    int i_MapsFD = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+    
+    if (i_MapsFD < 0)
+    {
+        return;
+    }
+    
+    char p_Buffer[1024];
+    ssize_t ss_Read;
+    
+    while ((ss_Read = read(i_MapsFD, p_Buffer, sizeof(p_Buffer))) > 0)
+    {
+        WriteRaw(i_MinidumpFD, p_Buffer, static_cast<size_t>(ss_Read));
+    }
+    
+    close(i_MapsFD);
+}
+
+void Logger::WriteRaw(int i_FD, const void* p_Buffer, size_t us_Size) noexcept
+{
+    const char* p_Data = static_cast<const char*>(p_Buffer);
+    ssize_t ss_Written;
+    
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    while (us_Size > 0 && (ss_Written = write(i_FD, p_Data, us_Size)) > 0)
     {
-        std::cout << s_Message << std::endl;
+        p_Data += ss_Written;
+        us_Size -= static_cast<size_t>(ss_Written);
     }
 }
 
@@ -18,13 +18,31 @@
 #define Logger_h
 
 // C / C++
-#include <fstream>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <cstring>
+#include <cstdio>
 
 // External
 
 // Project
 
+// Pre-defined
+#ifndef MRH_LOGGER_RECORD_SIZE
+    #define MRH_LOGGER_RECORD_SIZE 480
+#endif
+#ifndef MRH_LOGGER_BACKTRACE_SIZE
+    #define MRH_LOGGER_BACKTRACE_SIZE 64
+#endif
+#ifndef MRH_LOGGER_LEVEL
+    #define MRH_LOGGER_LEVEL 0 // Lowest Logger::LogLevel compiled in
+#endif
+
+struct iovec;
+
 
 class Logger
 {
@@ -84,21 +102,116 @@ public:
     
     void Log(LogLevel e_Level, std::string s_Message, std::string s_File, size_t us_Line) noexcept;
     
+    /**
+     *  Log a message.
+     *
+     *  \param p_Message The message to log.
+     *  \param us_MessageLength The length of the message in bytes.
+     *  \param p_File The source file this log was created from.
+     *  \param us_Line The source file line this log was created from.
+     */
+    
+    void Log(LogLevel e_Level, const char* p_Message, size_t us_MessageLength, const char* p_File, size_t us_Line) noexcept;
+    
+    /**
+     *  Log a message built from multiple values. The values are formatted into a 
+     *  stack buffer, no memory is allocated. Use the MRH_LOG_* macros instead of 
+     *  calling this function directly.
+     *
+     *  \param e_Level The log level.
+     *  \param p_File The source file this log was created from.
+     *  \param us_Line The source file line this log was created from.
+     *  \param Values The values to log.
+     */
+    
+    template<typename... Types>
+    void LogFormat(LogLevel e_Level, const char* p_File, size_t us_Line, Types const&... Values) noexcept
+    {
+        char p_Buffer[MRH_LOGGER_RECORD_SIZE];
+        size_t us_Length = 0;
+        
+        // Append in order, C++14 has no fold expressions
+        int p_Expand[] = { 0, (Append(p_Buffer, us_Length, Values), 0)... };
+        (void)p_Expand;
+        
+        Log(e_Level, p_Buffer, us_Length, p_File, us_Line);
+    }
+    
+    /**
+     *  Get the file name from a source file path.
+     *
+     *  \param p_Path The source file path.
+     *
+     *  \return The file name.
+     */
+    
+    static constexpr const char* GetFileName(const char* p_Path) noexcept
+    {
+        const char* p_Name = p_Path;
+        
+        for (; *p_Path != '\0'; ++p_Path)
+        {
+            if (*p_Path == '/')
+            {
+                p_Name = p_Path + 1;
+            }
+        }
+        
+        return p_Name;
+    }
+    
+    //*************************************************************************************
+    // Flush
+    //*************************************************************************************
+    
+    /**
+     *  Request the flusher thread to write all queued messages now. This function is 
+     *  async signal safe.
+     */
+    
+    void RequestFlush() noexcept;
+    
+    /**
+     *  Write all queued messages directly from the calling thread. This function is 
+     *  async signal safe and meant for crash handling.
+     */
+    
+    void FlushEmergency() noexcept;
+    
     //*************************************************************************************
     // Backtrace
     //*************************************************************************************
     
     /**
-     *  Write the program backtrace.
+     *  Write the program backtrace and, if enabled, a minidump. This function is 
+     *  async signal safe and meant for crash handling.
      *
-     *  \param us_TraceSize The size of the backtrace.
-     *  \param s_Message The message describing the backtrace cause.
+     *  \param i_Signal The signal which caused the backtrace.
      */
     
-    void Backtrace(size_t us_TraceSize, std::string s_Message) noexcept;
+    void Backtrace(int i_Signal) noexcept;
     
+    /**
+     *  Write the stack of the calling thread to the backtrace file without 
+     *  stopping. This function is async signal safe and meant for sampling stuck 
+     *  threads.
+     */
+    
+    void StackSample() noexcept;
+
 private:
     
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct LogRecord
+    {
+        std::atomic<size_t> us_Sequence;
+        size_t us_Length;
+        char p_Text[MRH_LOGGER_RECORD_SIZE];
+    };
+    
     //*************************************************************************************
     // Constructor / Destructor
     //*************************************************************************************
@@ -120,13 +233,168 @@ private:
     //*************************************************************************************
     
     /**
-     *  Write a line from the backtrace.
+     *  Write a buffer to a file descriptor. This function is async signal safe.
+     *
+     *  \param i_FD The file descriptor to write to.
+     *  \param p_Buffer The buffer to write.
+     *  \param us_Size The buffer size in bytes.
+     */
+    
+    static void WriteRaw(int i_FD, const void* p_Buffer, size_t us_Size) noexcept;
+    
+    /**
+     *  Write a titled stack to the backtrace file. This function is async signal 
+     *  safe.
      *
-     *  \param f_File The file to write to.
-     *  \param s_Message The message to write.
+     *  \param p_Title The title to write before the value.
+     *  \param i_Value The value shown in the title.
+     *  \param p_Frame The stack frame addresses.
+     *  \param i_FrameCount The amount of stack frames.
      */
     
-    void WriteBacktrace(std::ofstream& f_File, std::string s_Message) noexcept;
+    void WriteStack(const char* p_Title, long i_Value, void** p_Frame, int i_FrameCount) noexcept;
+    
+    /**
+     *  Write a minidump record for offline symbolization. This function is async 
+     *  signal safe.
+     *
+     *  \param i_Signal The signal which caused the backtrace.
+     *  \param p_Frame The stack frame addresses.
+     *  \param i_FrameCount The amount of stack frames.
+     */
+    
+    void WriteMinidump(int i_Signal, void** p_Frame, int i_FrameCount) noexcept;
+    
+    //*************************************************************************************
+    // Format
+    //*************************************************************************************
+    
+    /**
+     *  Format a log line.
+     *
+     *  \param p_Buffer The buffer to write to.
+     *  \param us_Size The size of the buffer in bytes.
+     *  \param e_Level The log level.
+     *  \param p_Message The message to log.
+     *  \param us_MessageLength The length of the message in bytes.
+     *  \param p_File The source file this log was created from.
+     *  \param us_Line The source file line this log was created from.
+     *
+     *  \return The length of the formatted line in bytes.
+     */
+    
+    size_t Format(char* p_Buffer, size_t us_Size, LogLevel e_Level, const char* p_Message, size_t us_MessageLength, const char* p_File, size_t us_Line) noexcept;
+    
+    //*************************************************************************************
+    // Append
+    //*************************************************************************************
+    
+    /**
+     *  Append a value to a message buffer. Values which do not fit are cut.
+     *
+     *  \param p_Buffer The message buffer of MRH_LOGGER_RECORD_SIZE bytes.
+     *  \param us_Length The current message length, updated on append.
+     *  \param Value The value to append.
+     */
+    
+    static void Append(char* p_Buffer, size_t& us_Length, const char* p_Value) noexcept
+    {
+        size_t us_Size = std::strlen(p_Value);
+        
+        if (us_Size > MRH_LOGGER_RECORD_SIZE - us_Length)
+        {
+            us_Size = MRH_LOGGER_RECORD_SIZE - us_Length;
+        }
+        
+        std::memcpy(p_Buffer + us_Length, p_Value, us_Size);
+        us_Length += us_Size;
+    }
+    
+    static void Append(char* p_Buffer, size_t& us_Length, std::string const& s_Value) noexcept
+    {
+        Append(p_Buffer, us_Length, s_Value.c_str());
+    }
+    
+    static void Append(char* p_Buffer, size_t& us_Length, char c_Value) noexcept
+    {
+        if (us_Length < MRH_LOGGER_RECORD_SIZE)
+        {
+            p_Buffer[us_Length++] = c_Value;
+        }
+    }
+    
+    static void Append(char* p_Buffer, size_t& us_Length, double f64_Value) noexcept
+    {
+        char p_Value[32];
+        
+        // Same output as std::to_string()
+        if (std::snprintf(p_Value, sizeof(p_Value), "%f", f64_Value) > 0)
+        {
+            Append(p_Buffer, us_Length, static_cast<const char*>(p_Value));
+        }
+    }
+    
+    template<typename Type>
+    static typename std::enable_if<std::is_integral<Type>::value>::type Append(char* p_Buffer, size_t& us_Length, Type Value) noexcept
+    {
+        // Widest value is a signed 64 bit integer
+        char p_Value[24];
+        size_t us_Pos = sizeof(p_Value);
+        bool b_Negative = Value < 0;
+        
+        p_Value[--us_Pos] = '\0';
+        
+        do
+        {
+            int i_Digit = static_cast<int>(Value % 10);
+            p_Value[--us_Pos] = '0' + (i_Digit < 0 ? -i_Digit : i_Digit);
+            Value /= 10;
+        }
+        while (Value != 0);
+        
+        if (b_Negative == true)
+        {
+            p_Value[--us_Pos] = '-';
+        }
+        
+        Append(p_Buffer, us_Length, static_cast<const char*>(p_Value + us_Pos));
+    }
+    
+    template<typename Type>
+    static typename std::enable_if<std::is_enum<Type>::value>::type Append(char* p_Buffer, size_t& us_Length, Type Value) noexcept
+    {
+        Append(p_Buffer, us_Length, static_cast<typename std::underlying_type<Type>::type>(Value));
+    }
+    
+    //*************************************************************************************
+    // Flush
+    //*************************************************************************************
+    
+    /**
+     *  Flusher thread function.
+     *
+     *  \param p_Instance The logger instance to flush.
+     */
+    
+    static void Flusher(Logger* p_Instance) noexcept;
+    
+    /**
+     *  Write the next batch of queued records. Only the flusher thread may call 
+     *  this function.
+     *
+     *  \return The amount of records written.
+     */
+    
+    size_t FlushRecords() noexcept;
+    
+    /**
+     *  Write a buffer list to the log file and the cli.
+     *
+     *  \param p_Buffer The buffers to write.
+     *  \param i_Count The amount of buffers.
+     */
+    
+    void WriteLines(struct iovec* p_Buffer, int i_Count) noexcept;
     
     //*************************************************************************************
     // Getters
@@ -144,11 +412,55 @@ private:
     // Data
     //*************************************************************************************
     
-    std::ofstream f_LogFile;
-    std::ofstream f_BacktraceFile;
+    // Files
+    int i_LogFD;
+    int i_BacktraceFD;
+    int i_MinidumpFD;
     
+    // Synchronous logging
+    std::mutex c_LogMutex;
+    
+    // Asynchronous logging
+    LogRecord* p_Record;
+    std::atomic<size_t> us_RecordTail;
+    size_t us_RecordHead; // Flusher only
+    std::atomic<size_t> us_Dropped;
+    std::atomic<bool> b_FlusherRun;
+    std::thread c_Flusher;
+    int i_WakeFD;
+
 protected:
     
 };
 
+//*************************************************************************************
+// Log Macros
+//*************************************************************************************
+
+// @NOTE: Levels below MRH_LOGGER_LEVEL are removed by the preprocessor, arguments 
+//        are not evaluated and no code is generated
+#define MRH_LOG(LEVEL, ...)                                                                     \
+    do                                                                                          \
+    {                                                                                           \
+        constexpr const char* p_LogFileName = Logger::GetFileName(__FILE__);                    \
+        Logger::Singleton().LogFormat(LEVEL, p_LogFileName, __LINE__, __VA_ARGS__);             \
+    }                                                                                           \
+    while (false)
+
+#if MRH_LOGGER_LEVEL <= 0
+    #define MRH_LOG_INFO(...) MRH_LOG(Logger::INFO, __VA_ARGS__)
+#else
+    #define MRH_LOG_INFO(...) do {} while (false)
+#endif
+#if MRH_LOGGER_LEVEL <= 1
+    #define MRH_LOG_WARNING(...) MRH_LOG(Logger::WARNING, __VA_ARGS__)
+#else
+    #define MRH_LOG_WARNING(...) do {} while (false)
+#endif
+#if MRH_LOGGER_LEVEL <= 2
+    #define MRH_LOG_ERROR(...) MRH_LOG(Logger::ERROR, __VA_ARGS__)
+#else
+    #define MRH_LOG_ERROR(...) do {} while (false)
+#endif
+
 #endif /* Logger_h */
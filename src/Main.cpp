@@ -17,17 +17,27 @@
 // C / C++
 #include <csignal>
 #include <cstring>
-#include <thread>
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
 
 // External
+#include <libmrhev.h>
 
 // Project
 #include "./Package/PackageService.h"
-#include "./Package/PackagePaths.h"
 #include "./Event/EventHandler.h"
+#include "./Event/EventSender.h"
+#include "./Event/EventPool.h"
 #include "./Environment.h"
+#include "./Scheduler.h"
+#include "./TimerWheel.h"
+#include "./ServiceHost.h"
+#include "./Watchdog.h"
 #include "./Logger.h"
-#include "./Timer.h"
+#include "./Metrics.h"
 #include "./Revision.h"
 
 
@@ -43,17 +53,17 @@ namespace
 #ifdef __MRH_MRHCKM_SUPPORTED__
         MRH_PARAM_BIN = 0,
         MRH_PARAM_PACKAGE_PATH = 1,
-        MRH_PARAM_EV_OUTPUT_FD = 2,
+        MRH_PARAM_EV_OUTPUT = 2,
         MRH_PARAM_EV_OUTPUT_KEY = 3,
         MRH_PARAM_EV_EVENT_LIMIT = 4,
-
+        
         MRH_PARAM_MAX = 4,
-
+        
         MRH_PARAM_COUNT = 5
 #else
         MRH_PARAM_BIN = 0,
         MRH_PARAM_PACKAGE_PATH = 1,
-        MRH_PARAM_EV_OUTPUT_FD = 2,
+        MRH_PARAM_EV_OUTPUT = 2,
         MRH_PARAM_EV_EVENT_LIMIT = 3,
 
         MRH_PARAM_MAX = 3,
@@ -61,9 +71,19 @@ namespace
         MRH_PARAM_COUNT = 4
 #endif
     }MRH_Parameters;
+    
+    // Transport used without --transport
+#ifdef __MRH_MRHCKM_SUPPORTED__
+    constexpr EventTransport::Type e_DefaultTransport = EventTransport::TRANSPORT_MRHCKM;
+#else
+    constexpr EventTransport::Type e_DefaultTransport = EventTransport::TRANSPORT_PIPE;
+#endif
+
+    // Optional parameters, given after the parameters
+    const char* p_TransportParam = "--transport=";
+    const char* p_PackageParam = "--package=";
+    const char* p_WorkersParam = "--workers=";
 
-    // Last signal
-    int i_LastSignal = -1;
 }
 
 //*************************************************************************************
@@ -75,6 +95,9 @@ extern "C"
 {
     void SignalHandler(int i_Signal)
     {
+        // Sampled threads continue in service code which might check errno
+        int i_Error = errno;
+        
         switch (i_Signal)
         {
             case SIGILL:
@@ -82,43 +105,182 @@ extern "C"
             case SIGFPE:
             case SIGABRT:
             case SIGSEGV:
-                Logger::Singleton().Backtrace(25, "Caught Signal: " + std::to_string(i_Signal));
-                exit(EXIT_FAILURE);
+                // @NOTE: Only async signal safe calls from here on
+                Logger::Singleton().FlushEmergency();
+                Logger::Singleton().Backtrace(i_Signal);
+                _exit(EXIT_FAILURE);
                 break;
                 
-            case SIGTERM:
-                i_LastSignal = i_Signal;
+            case Watchdog::i_SampleSignal:
+                // Sent by the watchdog to a thread stuck in a service callback
+                Logger::Singleton().StackSample();
                 break;
                 
             default:
-                i_LastSignal = -1;
                 break;
         }
+        
+        errno = i_Error;
+    }
+}
+
+//*************************************************************************************
+// Startup
+//*************************************************************************************
+
+static void LogPhase(const char* p_Phase, MRH_Uint64& u64_PhaseNS) noexcept
+{
+    MRH_Uint64 u64_NowNS = Metrics::GetTimeNS();
+    
+    MRH_LOG_INFO("Startup phase ", p_Phase, ": ", (u64_NowNS - u64_PhaseNS) / 1000, " us");
+    (void)p_Phase; // Unused without info logs
+    
+    u64_PhaseNS = u64_NowNS;
+}
+
+//*************************************************************************************
+// Send
+//*************************************************************************************
+
+static void ScheduleFlush(Scheduler* p_Scheduler, EventHandler* p_EventHandler) noexcept
+{
+    MRH_Uint64 u64_DeadlineNS;
+    
+    // Held events are sent on the deadline if no threshold is reached before
+    if (p_EventHandler->GetFlushDeadline(u64_DeadlineNS) == true)
+    {
+        p_Scheduler->Schedule(Scheduler::WAKE_FLUSH, u64_DeadlineNS);
+    }
+    else
+    {
+        p_Scheduler->Cancel(Scheduler::WAKE_FLUSH);
     }
 }
 
 //*************************************************************************************
-// Package Name
+// Host
 //*************************************************************************************
 
-static std::string GetPackageName(std::string const& s_PackagePath) noexcept
+static int RunHost(std::vector<const char*> const& v_PackagePath, const char* argv[], EventTransport::Type e_Transport, const char* p_Output, size_t us_WorkerCount) noexcept
 {
-    size_t us_ExtPos = s_PackagePath.find_last_of(PACKAGE_EXTENSION);
+    MRH_LOG_INFO("Initializing ", v_PackagePath.size(), " hosted packages ...");
+    
+    ServiceHost* p_Host = NULL;
+    EventHandler* p_EventHandler;
+    Environment* p_Environment;
+    Scheduler* p_Scheduler;
+    MRH_Uint64 u64_StartNS = Metrics::GetTimeNS();
+    MRH_Uint64 u64_PhaseNS = u64_StartNS;
+    
+    try
+    {
+        // @NOTE: The environment is per process, the first package sets the 
+        //        working directory for all
+        p_Scheduler = new Scheduler();
+        p_Host = new ServiceHost(v_PackagePath, argv[MRH_PARAM_EV_EVENT_LIMIT], p_Scheduler);
+        LogPhase("Configuration", u64_PhaseNS);
+        
+        // Read while the remaining setup runs
+        p_Host->Preload();
+        
+        p_Environment = new Environment(argv[MRH_PARAM_PACKAGE_PATH]);
+        // The output holds events up to the adaptive event limit
+        p_EventHandler = new EventHandler(e_Transport,
+                                          p_Output,
+                                          std::to_string(p_Host->GetFirstService()->GetMaxEventLimit()).c_str());
+        p_EventHandler->SetCoalescing(p_Host->GetFirstService()->GetCoalesceEvents(),
+                                      p_Host->GetFirstService()->GetCoalesceBytes(),
+                                      p_Host->GetFirstService()->GetCoalesceDelayUS());
+        p_Host->SetOutput(p_EventHandler->GetTransport());
+        LogPhase("Event Handler", u64_PhaseNS);
+        
+        p_Environment->LoadSystemLocale();
+        p_Environment->UpdateCurrentDir();
+        p_Environment->UpdateUserGroupID(p_Host->GetFirstService()->GetUserID(), p_Host->GetFirstService()->GetGroupID());
+        LogPhase("Environment", u64_PhaseNS);
+        
+        p_Host->Init(us_WorkerCount);
+        LogPhase("Service Load and Init", u64_PhaseNS);
+    }
+    catch (Exception& e)
+    {
+        MRH_LOG_ERROR("Failed to setup components: ", e.what());
+        return EXIT_FAILURE;
+    }
+    
+    MRH_LOG_INFO("Package Path: ", p_Environment->GetPackagePath());
+    MRH_LOG_INFO("Locale: ", p_Environment->GetLocale());
+    MRH_LOG_INFO("User ID: ", p_Environment->GetUserID());
+    MRH_LOG_INFO("Group ID: ", p_Environment->GetGroupID());
+    MRH_LOG_INFO("Event Transport: ", p_EventHandler->GetTransport()->GetName());
+    MRH_LOG_INFO("Service Workers: ", p_Host->GetWorkerCount());
+    MRH_LOG_INFO("Startup Time (US): ", (Metrics::GetTimeNS() - u64_StartNS) / 1000);
+    MRH_LOG_INFO("Hosted application services initialized, now running...");
+    
+    // Updates run on the workers, events are sent from here
+    p_Scheduler->Schedule(Scheduler::WAKE_UPDATE, p_Host->GetNextUpdateNS());
     
-    if (us_ExtPos == std::string::npos)
+    bool b_Run = true;
+    
+    while (b_Run == true)
     {
-        return "unknown";
+        switch (p_Scheduler->Wait())
+        {
+            case Scheduler::WAKE_SIGNAL:
+                MRH_LOG_INFO("Recieved signal ", p_Scheduler->GetSignal(), ", stopping...");
+                b_Run = false;
+                continue;
+            
+            case Scheduler::WAKE_UPDATE:
+                p_Host->DispatchUpdates();
+                break;
+            
+            case Scheduler::WAKE_EVENTS:
+            case Scheduler::WAKE_OUTPUT:
+            case Scheduler::WAKE_FLUSH:
+                p_Host->SendEvents(p_EventHandler);
+                p_EventHandler->SendEvents();
+                
+                ScheduleFlush(p_Scheduler, p_EventHandler);
+                p_Scheduler->WatchOutput(p_EventHandler->GetRemainingEvents() == true ? p_EventHandler->GetOutputFD() : -1,
+                                         p_EventHandler->GetOutputDoorbell());
+                break;
+            
+            default:
+                break;
+        }
+        
+        if (p_Host->GetRunningCount() == 0)
+        {
+            MRH_LOG_INFO("All hosted application services failed to update!");
+            break;
+        }
+        
+        // Finished updates change the next due service
+        p_Scheduler->Schedule(Scheduler::WAKE_UPDATE, p_Host->GetNextUpdateNS());
     }
     
-    us_ExtPos += std::strlen(PACKAGE_EXTENSION);
-    size_t us_SlashPos = s_PackagePath.find_last_of("/", us_ExtPos);
+    // Exit application
+    MRH_LOG_INFO("Calling hosted application service exit...");
+    p_Host->Stop();
+    
+    MRH_LOG_INFO("Sending remaining and parent stop events...");
+    
+    MRH_Uint32 u32_DeadlineMS = p_Host->GetFirstService()->GetDrainDeadlineMS();
     
-    if (us_SlashPos == std::string::npos)
+    if (p_Host->Drain(p_EventHandler, u32_DeadlineMS) == false)
     {
-        us_SlashPos = 0;
+        MRH_LOG_WARNING("Drain deadline of ", u32_DeadlineMS, " ms reached, remaining events are dropped!");
     }
     
-    return s_PackagePath.substr(us_SlashPos, us_ExtPos);
+    // Done, clean up
+    delete p_Host;
+    delete p_EventHandler;
+    delete p_Environment;
+    delete p_Scheduler;
+    
+    MRH_LOG_INFO("Hosted application services finished.");
+    return EXIT_SUCCESS;
 }
 
 //*************************************************************************************
@@ -127,68 +289,151 @@ static std::string GetPackageName(std::string const& s_PackagePath) noexcept
 
 int main(int argc, const char* argv[])
 {
+    // Control signals are read by the scheduler, threads created later
+    // inherit the blocked signals
+    Scheduler::BlockSignals();
+    
     // Log Setup
     Logger& c_Logger = Logger::Singleton();
-    c_Logger.OpenFiles(GetPackageName(argc > MRH_PARAM_PACKAGE_PATH ? argv[MRH_PARAM_PACKAGE_PATH] : ""));
+    c_Logger.OpenFiles(PackageConfiguration::GetPackageName(argc > MRH_PARAM_PACKAGE_PATH ? argv[MRH_PARAM_PACKAGE_PATH] : ""));
     
-    c_Logger.Log(Logger::INFO, "=============================================", "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "= Started MRH User App Service Parent (" + std::string(VERSION_NUMBER) + ")", "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "=============================================", "Main.cpp", __LINE__);
+    MRH_LOG_INFO("=============================================");
+    MRH_LOG_INFO("= Started MRH User App Service Parent (", VERSION_NUMBER, ")");
+    MRH_LOG_INFO("=============================================");
     
     // Check params
     if (argc < MRH_PARAM_COUNT)
     {
-        c_Logger.Log(Logger::ERROR, "Missing app service parent parameters!",
-                     "Main.cpp", __LINE__);
+        MRH_LOG_ERROR("Missing app service parent parameters!");
         return EXIT_FAILURE;
     }
     
+    // Metrics page for external tools, metrics stay local on failure
+    if (Metrics::Singleton().Open(PackageConfiguration::GetPackageName(argv[MRH_PARAM_PACKAGE_PATH])) == true)
+    {
+        MRH_LOG_INFO("Metrics page: ", Metrics::Singleton().GetPageName());
+    }
+    else
+    {
+        MRH_LOG_WARNING("Failed to publish metrics page: ", std::strerror(errno));
+    }
+    
     // Print mrhevlib info
-    c_Logger.Log(Logger::INFO, "Using mrhevlib version " +
-                               std::to_string(MRH_EV_LIB_VERSION_MAJOR) +
-                               "." +
-                               std::to_string(MRH_EV_LIB_VERSION_MINOR) +
-                               "." +
-                               std::to_string(MRH_EV_LIB_VERSION_PATCH) +
-                               ".",
-                 "Main.cpp", __LINE__);
+    MRH_LOG_INFO("Using mrhevlib version ",
+                 MRH_EV_LIB_VERSION_MAJOR,
+                 ".",
+                 MRH_EV_LIB_VERSION_MINOR,
+                 ".",
+                 MRH_EV_LIB_VERSION_PATCH,
+                 ".");
+    
+    // The transport defines the output parameter format, additional
+    // packages switch to host mode
+    EventTransport::Type e_Transport = e_DefaultTransport;
+    std::vector<const char*> v_PackagePath(1, argv[MRH_PARAM_PACKAGE_PATH]);
+    size_t us_WorkerCount = 0;
+    
+    for (int i = MRH_PARAM_COUNT; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], p_TransportParam, std::strlen(p_TransportParam)) == 0)
+        {
+            if (EventTransport::GetType(argv[i] + std::strlen(p_TransportParam), e_Transport) == false)
+            {
+                MRH_LOG_WARNING("Unknown event transport ", argv[i], ", using the default!");
+                e_Transport = e_DefaultTransport;
+            }
+        }
+        else if (std::strncmp(argv[i], p_PackageParam, std::strlen(p_PackageParam)) == 0)
+        {
+            v_PackagePath.emplace_back(argv[i] + std::strlen(p_PackageParam));
+        }
+        else if (std::strncmp(argv[i], p_WorkersParam, std::strlen(p_WorkersParam)) == 0)
+        {
+            us_WorkerCount = std::strtoul(argv[i] + std::strlen(p_WorkersParam), NULL, 10);
+        }
+        else
+        {
+            MRH_LOG_WARNING("Unknown parameter ", argv[i], " ignored!");
+        }
+    }
     
+    // MRHCKM builds give the output key as its own parameter, the 
+    // transport takes both as one
+    std::string s_Output(argv[MRH_PARAM_EV_OUTPUT]);
+
 #ifdef __MRH_MRHCKM_SUPPORTED__
-    c_Logger.Log(Logger::INFO, "Event transmission method: MRHCKM.", "Main.cpp", __LINE__);
-#else
-    c_Logger.Log(Logger::INFO, "Event transmission method: Pipe.", "Main.cpp", __LINE__);
+    if (e_Transport == EventTransport::TRANSPORT_MRHCKM)
+    {
+        s_Output += ",";
+        s_Output += argv[MRH_PARAM_EV_OUTPUT_KEY];
+    }
 #endif
-    
+
     // Install signal handlers
-    std::signal(SIGTERM, SignalHandler);
-    std::signal(SIGILL, SignalHandler);
-    std::signal(SIGTRAP, SignalHandler);
-    std::signal(SIGFPE, SignalHandler);
-    std::signal(SIGABRT, SignalHandler);
-    std::signal(SIGSEGV, SignalHandler);
+    struct sigaction c_Action;
+    
+    if (Scheduler::SetSignalStack() == false)
+    {
+        MRH_LOG_WARNING("Failed to set signal stack: ", std::strerror(errno));
+    }
+    
+    std::memset(&c_Action, 0, sizeof(c_Action));
+    sigemptyset(&c_Action.sa_mask);
+    c_Action.sa_handler = SignalHandler;
+    
+    // Sampled service calls continue, interrupted system calls as well
+    c_Action.sa_flags = SA_ONSTACK | SA_RESTART;
+    sigaction(Watchdog::i_SampleSignal, &c_Action, NULL);
+    
+    // A crash inside the handler uses the default action
+    c_Action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+    
+    for (int i_Signal : { SIGILL, SIGTRAP, SIGFPE, SIGABRT, SIGSEGV })
+    {
+        sigaction(i_Signal, &c_Action, NULL);
+    }
+    
+    // Multiple packages share this process
+    if (v_PackagePath.size() > 1)
+    {
+        return RunHost(v_PackagePath, argv, e_Transport, s_Output.c_str(), us_WorkerCount);
+    }
     
     // Setup components
-    c_Logger.Log(Logger::INFO, "Initializing " + std::string(argv[MRH_PARAM_PACKAGE_PATH]) + " ...", "Main.cpp", __LINE__);
+    MRH_LOG_INFO("Initializing ", argv[MRH_PARAM_PACKAGE_PATH], " ...");
     
     PackageService* p_Service;
     EventHandler* p_EventHandler;
     Environment* p_Environment;
-    Timer s_Timer;
+    Scheduler* p_Scheduler;
+    EventSender* p_EventSender = NULL;
+    MRH_Uint64 u64_StartNS = Metrics::GetTimeNS();
+    MRH_Uint64 u64_PhaseNS = u64_StartNS;
     
     try
     {
         // Allocation and constructor setup
         p_Service = new PackageService(argv[MRH_PARAM_PACKAGE_PATH],
                                        argv[MRH_PARAM_EV_EVENT_LIMIT]);
+        LogPhase("Configuration", u64_PhaseNS);
+        
+        // The shared object is read while the remaining setup runs
+        if (p_Service->GetPreload() == true)
+        {
+            p_Service->Preload();
+        }
+        
         p_Environment = new Environment(argv[MRH_PARAM_PACKAGE_PATH]);
-#ifdef __MRH_MRHCKM_SUPPORTED__
-        p_EventHandler = new EventHandler(argv[MRH_PARAM_EV_OUTPUT_FD],
-                                          argv[MRH_PARAM_EV_OUTPUT_KEY],
-                                          argv[MRH_PARAM_EV_EVENT_LIMIT]);
-#else
-        p_EventHandler = new EventHandler(argv[MRH_PARAM_EV_OUTPUT_FD],
-                                          argv[MRH_PARAM_EV_EVENT_LIMIT]);
-#endif
+        // The output holds events up to the adaptive event limit
+        p_EventHandler = new EventHandler(e_Transport,
+                                          s_Output.c_str(),
+                                          std::to_string(p_Service->GetMaxEventLimit()).c_str());
+        p_EventHandler->SetCoalescing(p_Service->GetCoalesceEvents(),
+                                      p_Service->GetCoalesceBytes(),
+                                      p_Service->GetCoalesceDelayUS());
+        p_Service->SetOutput(p_EventHandler->GetTransport());
+        p_Scheduler = new Scheduler();
+        LogPhase("Event Handler", u64_PhaseNS);
         
         // Set environment
         // @NOTE: This has to happen in this order before the user app functions are called!
@@ -196,60 +441,142 @@ int main(int argc, const char* argv[])
         p_Environment->LoadSystemLocale();
         p_Environment->UpdateCurrentDir();
         p_Environment->UpdateUserGroupID(p_Service->GetUserID(), p_Service->GetGroupID());
+        LogPhase("Environment", u64_PhaseNS);
         
         // Initialize app service
         p_Service->LoadSharedObject();
+        LogPhase("Shared Object", u64_PhaseNS);
+        
+        if (p_Service->SetEventNotify(Scheduler::NotifyEvents, p_Scheduler) == true)
+        {
+            MRH_LOG_INFO("Application service supports event notification.");
+        }
+        
+        // The transport decides if events are pooled
+        if (EventPool::Singleton().GetEnabled() == true &&
+            p_Service->SetEventPool(EventPool::AcquireEvent, EventPool::ReleaseEvent) == true)
+        {
+            MRH_LOG_INFO("Application service uses the event pool.");
+        }
+        
         p_Service->Init();
+        LogPhase("Service Init", u64_PhaseNS);
+        
+        // Pipelined sending, started after init since init might fail
+        if (p_Service->GetSenderThread() == true)
+        {
+            p_EventSender = new EventSender(p_EventHandler, p_Service->GetMaxEventLimit(), p_Service->GetRemainingEvents());
+        }
     }
     catch (Exception& e)
     {
-        c_Logger.Log(Logger::ERROR, std::string("Failed to setup components: ") + e.what(), "Main.cpp", __LINE__);
+        MRH_LOG_ERROR("Failed to setup components: ", e.what());
         return EXIT_FAILURE;
     }
     
-    c_Logger.Log(Logger::INFO, "Package Path: " + p_Environment->GetPackagePath(), "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "Locale: " + p_Environment->GetLocale(), "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "User ID: " + std::to_string(p_Environment->GetUserID()), "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "Group ID: " + std::to_string(p_Environment->GetGroupID()), "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "Update Timer (Seconds): " + std::to_string(p_Service->GetUpdateTimerS()), "Main.cpp", __LINE__);
-    c_Logger.Log(Logger::INFO, "Application service initialized, now running...", "Main.cpp", __LINE__);
+    MRH_LOG_INFO("Package Path: ", p_Environment->GetPackagePath());
+    MRH_LOG_INFO("Locale: ", p_Environment->GetLocale());
+    MRH_LOG_INFO("User ID: ", p_Environment->GetUserID());
+    MRH_LOG_INFO("Group ID: ", p_Environment->GetGroupID());
+    MRH_LOG_INFO("Update Timer (Seconds): ", p_Service->GetUpdateTimerS());
+    MRH_LOG_INFO("Event Transport: ", p_EventHandler->GetTransport()->GetName());
+    MRH_LOG_INFO("Sender Thread: ", p_EventSender != NULL ? "Yes" : "No");
+    MRH_LOG_INFO("Event Limit: ", p_Service->GetEventLimit(), " (Max ", p_Service->GetMaxEventLimit(), ")");
+    MRH_LOG_INFO("Event Coalescing: ", p_Service->GetCoalesceEvents(), " Events, ", p_Service->GetCoalesceBytes(), " Bytes, ", p_Service->GetCoalesceDelayUS(), " US");
+    MRH_LOG_INFO("Watchdog Limits (MS): ", p_Service->GetWatchdogSoftLimitMS(), " Soft, ", p_Service->GetWatchdogHardLimitMS(), " Hard");
+    MRH_LOG_INFO("Symbol Binding: ", p_Service->GetLazyBinding() == true ? "Lazy" : "Now");
+    MRH_LOG_INFO("Startup Time (US): ", (Metrics::GetTimeNS() - u64_StartNS) / 1000);
+    MRH_LOG_INFO("Application service initialized, now running...");
     
     // Send events until termination
-    while (i_LastSignal != SIGTERM)
+    // @NOTE: The first update is due right away, control signals wake the wait
+    MRH_Uint64 u64_UpdatePeriodNS = static_cast<MRH_Uint64>(p_Service->GetUpdateTimerS()) * 1000000000;
+    MRH_Uint64 u64_UpdateNS = Metrics::GetTimeNS();
+    bool b_Run = true;
+    
+    p_Scheduler->Schedule(Scheduler::WAKE_UPDATE, u64_UpdateNS);
+    
+    while (b_Run == true)
     {
-        s_Timer.Reset();
-        
-        if (p_Service->Update() == false)
+        switch (p_Scheduler->Wait())
         {
-            c_Logger.Log(Logger::INFO, "Application service failed to update!", "Main.cpp", __LINE__);
-            break;
-        }
-        
-        p_EventHandler->SendEvents(p_Service->RecieveEvents());
-        
-        if (s_Timer.GetTimePassedSeconds() < p_Service->GetUpdateTimerS())
-        {
-            std::this_thread::sleep_for(std::chrono::seconds(p_Service->GetUpdateTimerS() - static_cast<MRH_Uint32>(s_Timer.GetTimePassedSeconds())));
+            case Scheduler::WAKE_SIGNAL:
+                MRH_LOG_INFO("Recieved signal ", p_Scheduler->GetSignal(), ", stopping...");
+                b_Run = false;
+                break;
+            
+            case Scheduler::WAKE_UPDATE:
+                // Next update follows the last deadline, update time does not drift
+                u64_UpdateNS = TimerWheel::GetPeriodDeadline(u64_UpdateNS, u64_UpdatePeriodNS, Metrics::GetTimeNS());
+                p_Scheduler->Schedule(Scheduler::WAKE_UPDATE, u64_UpdateNS);
+                
+                if (p_Service->Update() == false)
+                {
+                    MRH_LOG_INFO("Application service failed to update!");
+                    b_Run = false;
+                    break;
+                }
+                
+                // Events are recieved after each update
+                // fall through
+            case Scheduler::WAKE_EVENTS:
+            case Scheduler::WAKE_OUTPUT:
+            case Scheduler::WAKE_FLUSH:
+                if (p_EventSender != NULL)
+                {
+                    p_EventSender->Push(p_Service->RecieveEvents());
+                }
+                else
+                {
+                    p_EventHandler->SendEvents(p_Service->RecieveEvents());
+                    
+                    // Continue once the reader made space, no polling
+                    ScheduleFlush(p_Scheduler, p_EventHandler);
+                    p_Scheduler->WatchOutput(p_EventHandler->GetRemainingEvents() == true ? p_EventHandler->GetOutputFD() : -1,
+                                             p_EventHandler->GetOutputDoorbell());
+                }
+                break;
+            
+            default:
+                break;
         }
     }
     
     // Exit application
-    c_Logger.Log(Logger::INFO, "Calling application service exit...", "Main.cpp", __LINE__);
+    MRH_LOG_INFO("Calling application service exit...");
     p_Service->Exit();
     
     // Send stop an remaining events
-    c_Logger.Log(Logger::INFO, "Sending remaining and parent stop events...", "Main.cpp", __LINE__);
+    MRH_LOG_INFO("Sending remaining and parent stop events...");
+    
+    // @NOTE: One deadline for all remaining events, sender events were 
+    //        recieved first
+    MRH_Uint32 u32_DeadlineMS = p_Service->GetDrainDeadlineMS();
+    MRH_Uint64 u64_DrainStart = Metrics::GetTimeNS();
+    bool b_Drained = true;
+    
+    if (p_EventSender != NULL)
+    {
+        p_EventSender->Stop();
+        b_Drained = p_EventHandler->Drain(p_EventSender->GetRemainingEvents(), u32_DeadlineMS);
+        
+        delete p_EventSender;
+    }
+    
+    MRH_Uint64 u64_DrainMS = (Metrics::GetTimeNS() - u64_DrainStart) / 1000000;
     
-    while (p_EventHandler->GetRemainingEvents() == true)
+    if (b_Drained == false ||
+        p_EventHandler->Drain(p_Service->GetRemainingEvents(), u64_DrainMS < u32_DeadlineMS ? u32_DeadlineMS - u64_DrainMS : 0) == false)
     {
-        p_EventHandler->SendEvents();
+        MRH_LOG_WARNING("Drain deadline of ", u32_DeadlineMS, " ms reached, remaining events are dropped!");
     }
     
     // Done, clean up
     delete p_Service;
     delete p_EventHandler;
     delete p_Environment;
+    delete p_Scheduler;
     
-    c_Logger.Log(Logger::INFO, "User application service finished.", "Main.cpp", __LINE__);
+    MRH_LOG_INFO("User application service finished.");
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,289 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+
+// External
+
+// Project
+#include "./Metrics.h"
+
+// Pre-defined
+#ifndef MRH_USERVICE_METRICS_SHM_NAME_BASE
+    #define MRH_USERVICE_METRICS_SHM_NAME_BASE "/mrhuservice_"
+#endif
+
+namespace
+{
+    constexpr MRH_Uint32 u32_PageVersion = 10;
+    
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared metrics require lock free 64 bit atomics!");
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+Metrics::Metrics() noexcept : p_Page(&c_LocalPage),
+                              us_ServiceUsed(0),
+                              s_PageName("")
+{
+    InitPage(&c_LocalPage);
+}
+
+Metrics::~Metrics() noexcept
+{
+    if (p_Page != &c_LocalPage)
+    {
+        munmap(p_Page, sizeof(MetricsPage));
+        shm_unlink(s_PageName.c_str());
+    }
+}
+
+//*************************************************************************************
+// Singleton
+//*************************************************************************************
+
+Metrics& Metrics::Singleton() noexcept
+{
+    static Metrics c_Metrics;
+    return c_Metrics;
+}
+
+//*************************************************************************************
+// Open
+//*************************************************************************************
+
+bool Metrics::Open(std::string const& s_PackageName) noexcept
+{
+    if (p_Page != &c_LocalPage)
+    {
+        return true;
+    }
+    
+    std::string s_Name(MRH_USERVICE_METRICS_SHM_NAME_BASE + s_PackageName);
+    
+    // Readable for scraping, a page left by a crashed run is reused
+    int i_FD = shm_open(s_Name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    
+    if (i_FD < 0)
+    {
+        return false;
+    }
+    
+    if (ftruncate(i_FD, sizeof(MetricsPage)) < 0)
+    {
+        close(i_FD);
+        shm_unlink(s_Name.c_str());
+        return false;
+    }
+    
+    void* p_Memory = mmap(NULL, sizeof(MetricsPage), PROT_READ | PROT_WRITE, MAP_SHARED, i_FD, 0);
+    close(i_FD);
+    
+    if (p_Memory == MAP_FAILED)
+    {
+        shm_unlink(s_Name.c_str());
+        return false;
+    }
+    
+    // Keep values recorded before publishing
+    MetricsPage* p_Shared = static_cast<MetricsPage*>(p_Memory);
+    InitPage(p_Shared);
+    
+    for (size_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        p_Shared->p_Counter[i].store(c_LocalPage.p_Counter[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    
+    for (size_t i = 0; i < GAUGE_COUNT; ++i)
+    {
+        p_Shared->p_Gauge[i].store(c_LocalPage.p_Gauge[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    
+    for (size_t i = 0; i < HISTOGRAM_COUNT; ++i)
+    {
+        for (size_t j = 0; j < us_BucketCount; ++j)
+        {
+            p_Shared->p_Histogram[i][j].store(c_LocalPage.p_Histogram[i][j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+    
+    for (size_t i = 0; i < us_TransportCount; ++i)
+    {
+        for (size_t j = 0; j < TRANSPORT_COUNTER_COUNT; ++j)
+        {
+            p_Shared->p_Transport[i][j].store(c_LocalPage.p_Transport[i][j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+    
+    for (size_t i = 0; i < us_ServiceCount; ++i)
+    {
+        for (size_t j = 0; j < SERVICE_GAUGE_COUNT; ++j)
+        {
+            p_Shared->p_ServiceGauge[i][j].store(c_LocalPage.p_ServiceGauge[i][j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+    
+    std::memcpy(p_Shared->p_ServiceName, c_LocalPage.p_ServiceName, sizeof(p_Shared->p_ServiceName));
+    
+    p_Page = p_Shared;
+    s_PageName = s_Name;
+    
+    return true;
+}
+
+size_t Metrics::AddService(std::string const& s_PackageName) noexcept
+{
+    size_t us_Service = us_ServiceUsed.fetch_add(1, std::memory_order_relaxed);
+    
+    if (us_Service >= us_ServiceCount)
+    {
+        return us_ServiceCount;
+    }
+    
+    // Always terminated, long names are cut
+    std::strncpy(p_Page->p_ServiceName[us_Service], s_PackageName.c_str(), us_ServiceNameSize - 1);
+    p_Page->p_ServiceName[us_Service][us_ServiceNameSize - 1] = '\0';
+    
+    return us_Service;
+}
+
+//*************************************************************************************
+// Page
+//*************************************************************************************
+
+void Metrics::InitPage(MetricsPage* p_Target) noexcept
+{
+    std::memcpy(p_Target->p_Magic, "MRHUSMET", sizeof(p_Target->p_Magic));
+    p_Target->u32_Version = u32_PageVersion;
+    p_Target->u32_Size = sizeof(MetricsPage);
+    p_Target->u32_CounterCount = COUNTER_COUNT;
+    p_Target->u32_GaugeCount = GAUGE_COUNT;
+    p_Target->u32_HistogramCount = HISTOGRAM_COUNT;
+    p_Target->u32_BucketCount = us_BucketCount;
+    p_Target->u32_TransportCount = us_TransportCount;
+    p_Target->u32_TransportCounterCount = TRANSPORT_COUNTER_COUNT;
+    p_Target->u32_ServiceCount = us_ServiceCount;
+    p_Target->u32_ServiceGaugeCount = SERVICE_GAUGE_COUNT;
+    p_Target->u32_ServiceNameSize = us_ServiceNameSize;
+    p_Target->u32_Reserved = 0;
+    p_Target->u64_PID = static_cast<MRH_Uint64>(getpid());
+    
+    for (auto& Counter : p_Target->p_Counter)
+    {
+        Counter.store(0, std::memory_order_relaxed);
+    }
+    
+    for (auto& Gauge : p_Target->p_Gauge)
+    {
+        Gauge.store(0, std::memory_order_relaxed);
+    }
+    
+    for (auto& Histogram : p_Target->p_Histogram)
+    {
+        for (auto& Bucket : Histogram)
+        {
+            Bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    for (auto& Transport : p_Target->p_Transport)
+    {
+        for (auto& Counter : Transport)
+        {
+            Counter.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    for (auto& Service : p_Target->p_ServiceGauge)
+    {
+        for (auto& Gauge : Service)
+        {
+            Gauge.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    std::memset(p_Target->p_ServiceName, 0, sizeof(p_Target->p_ServiceName));
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void Metrics::Add(Counter e_Counter, MRH_Uint64 u64_Value) noexcept
+{
+    p_Page->p_Counter[e_Counter].fetch_add(u64_Value, std::memory_order_relaxed);
+}
+
+void Metrics::Add(size_t us_Transport, TransportCounter e_Counter, MRH_Uint64 u64_Value) noexcept
+{
+    p_Page->p_Transport[us_Transport][e_Counter].fetch_add(u64_Value, std::memory_order_relaxed);
+}
+
+void Metrics::Set(Gauge e_Gauge, MRH_Uint64 u64_Value) noexcept
+{
+    p_Page->p_Gauge[e_Gauge].store(u64_Value, std::memory_order_relaxed);
+}
+
+void Metrics::Set(size_t us_Service, ServiceGauge e_Gauge, MRH_Uint64 u64_Value) noexcept
+{
+    if (us_Service < us_ServiceCount)
+    {
+        p_Page->p_ServiceGauge[us_Service][e_Gauge].store(u64_Value, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::Record(Histogram e_Histogram, MRH_Uint64 u64_Value) noexcept
+{
+    size_t us_Bucket = 0;
+    
+    if (u64_Value > 0)
+    {
+        us_Bucket = 64 - __builtin_clzll(u64_Value);
+        
+        if (us_Bucket >= us_BucketCount)
+        {
+            us_Bucket = us_BucketCount - 1;
+        }
+    }
+    
+    p_Page->p_Histogram[e_Histogram][us_Bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint64 Metrics::GetTimeNS() noexcept
+{
+    struct timespec c_Time;
+    clock_gettime(CLOCK_MONOTONIC, &c_Time);
+    
+    return static_cast<MRH_Uint64>(c_Time.tv_sec) * 1000000000ULL + static_cast<MRH_Uint64>(c_Time.tv_nsec);
+}
+
+std::string const& Metrics::GetPageName() const noexcept
+{
+    return s_PageName;
+}
@@ -0,0 +1,330 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef Metrics_h
+#define Metrics_h
+
+// C / C++
+#include <atomic>
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+
+class Metrics
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        // Update
+        COUNTER_UPDATE = 0,
+        COUNTER_UPDATE_FAILED = 1,
+        COUNTER_UPDATE_TIME_NS = 2,
+        
+        // Recieve
+        COUNTER_EVENTS_RECIEVED = 3,
+        COUNTER_EVENT_LIMIT_REACHED = 4,
+        
+        // Send
+        COUNTER_EVENTS_SENT = 5,
+        COUNTER_ADD_EVENT_FAILED = 6,
+        COUNTER_SEND_TIME_NS = 7,
+        COUNTER_EVENTS_DROPPED = 8,
+        
+        // Host
+        COUNTER_UPDATE_STOLEN = 9,
+        
+        // Watchdog
+        COUNTER_WATCHDOG_SAMPLES = 10,
+        
+        // Coalescing
+        COUNTER_FLUSH_DELAY = 11,
+        
+        // Quota
+        COUNTER_EVENTS_OVER_QUOTA = 12,
+        
+        COUNTER_MAX = COUNTER_EVENTS_OVER_QUOTA,
+        
+        COUNTER_COUNT = COUNTER_MAX + 1
+    
+    }Counter;
+    
+    typedef enum
+    {
+        GAUGE_SENDER_QUEUE_DEPTH = 0,
+        
+        GAUGE_MAX = GAUGE_SENDER_QUEUE_DEPTH,
+        
+        GAUGE_COUNT = GAUGE_MAX + 1
+    
+    }Gauge;
+    
+    typedef enum
+    {
+        HISTOGRAM_UPDATE_US = 0,
+        HISTOGRAM_EVENTS_PER_CYCLE = 1,
+        HISTOGRAM_SEND_US = 2,
+        HISTOGRAM_UPDATE_DELAY_US = 3,
+        HISTOGRAM_BATCH_EVENTS = 4,
+        HISTOGRAM_BATCH_BYTES = 5,
+        
+        // @NOTE: One per event container priority lane, in lane order
+        HISTOGRAM_LANE_HIGH_US = 6,
+        HISTOGRAM_LANE_NORMAL_US = 7,
+        HISTOGRAM_LANE_LOW_US = 8,
+        
+        HISTOGRAM_MAX = HISTOGRAM_LANE_LOW_US,
+        
+        HISTOGRAM_COUNT = HISTOGRAM_MAX + 1
+    
+    }Histogram;
+    
+    // @NOTE: Kept per transport, each transport has its own set
+    typedef enum
+    {
+        TRANSPORT_COUNTER_EVENTS = 0,
+        TRANSPORT_COUNTER_BYTES = 1,
+        TRANSPORT_COUNTER_SENDS = 2,
+        TRANSPORT_COUNTER_SEND_TIME_NS = 3,
+        TRANSPORT_COUNTER_FULL = 4,
+        
+        TRANSPORT_COUNTER_MAX = TRANSPORT_COUNTER_FULL,
+        
+        TRANSPORT_COUNTER_COUNT = TRANSPORT_COUNTER_MAX + 1
+    
+    }TransportCounter;
+    
+    // Transport counter sets in the page
+    static constexpr size_t us_TransportCount = 3;
+    
+    // @NOTE: Kept per service, each hosted service has its own set
+    typedef enum
+    {
+        SERVICE_GAUGE_QUEUE_DEPTH = 0,
+        SERVICE_GAUGE_EVENT_LIMIT = 1,
+        
+        SERVICE_GAUGE_MAX = SERVICE_GAUGE_EVENT_LIMIT,
+        
+        SERVICE_GAUGE_COUNT = SERVICE_GAUGE_MAX + 1
+    
+    }ServiceGauge;
+    
+    // Service gauge sets in the page, later services are not recorded
+    static constexpr size_t us_ServiceCount = 32;
+    static constexpr size_t us_ServiceNameSize = 64;
+    
+    //*************************************************************************************
+    // Singleton
+    //*************************************************************************************
+    
+    /**
+     *  Get the class instance. This function is thread safe.
+     *
+     *  \return The class instance.
+     */
+    
+    static Metrics& Singleton() noexcept;
+    
+    //*************************************************************************************
+    // Open
+    //*************************************************************************************
+    
+    /**
+     *  Publish the metrics in a shared memory page. Metrics are kept in process 
+     *  memory until this function succeeds. Call before starting other threads.
+     *
+     *  \param s_PackageName The name of the package for the page name.
+     *
+     *  \return true on success, false on failure.
+     */
+    
+    bool Open(std::string const& s_PackageName) noexcept;
+    
+    /**
+     *  Add a service gauge set. This function is thread safe.
+     *
+     *  \param s_PackageName The name of the package of the service.
+     *
+     *  \return The service gauge set, us_ServiceCount if all sets are used.
+     */
+    
+    size_t AddService(std::string const& s_PackageName) noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Add to a counter. This function is thread safe.
+     *
+     *  \param e_Counter The counter to add to.
+     *  \param u64_Value The value to add.
+     */
+    
+    void Add(Counter e_Counter, MRH_Uint64 u64_Value) noexcept;
+    
+    /**
+     *  Add to a transport counter. This function is thread safe.
+     *
+     *  \param us_Transport The transport to add to.
+     *  \param e_Counter The counter to add to.
+     *  \param u64_Value The value to add.
+     */
+    
+    void Add(size_t us_Transport, TransportCounter e_Counter, MRH_Uint64 u64_Value) noexcept;
+    
+    /**
+     *  Set a gauge. This function is thread safe.
+     *
+     *  \param e_Gauge The gauge to set.
+     *  \param u64_Value The new value.
+     */
+    
+    void Set(Gauge e_Gauge, MRH_Uint64 u64_Value) noexcept;
+    
+    /**
+     *  Set a service gauge. This function is thread safe.
+     *
+     *  \param us_Service The service gauge set to use.
+     *  \param e_Gauge The gauge to set.
+     *  \param u64_Value The new value.
+     */
+    
+    void Set(size_t us_Service, ServiceGauge e_Gauge, MRH_Uint64 u64_Value) noexcept;
+    
+    /**
+     *  Add a value to a log2 histogram. This function is thread safe.
+     *
+     *  \param e_Histogram The histogram to add to.
+     *  \param u64_Value The value to add.
+     */
+    
+    void Record(Histogram e_Histogram, MRH_Uint64 u64_Value) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the current monotonic time.
+     *
+     *  \return The time in nanoseconds.
+     */
+    
+    static MRH_Uint64 GetTimeNS() noexcept;
+    
+    /**
+     *  Get the shared memory page name.
+     *
+     *  \return The page name, empty if not published.
+     */
+    
+    std::string const& GetPageName() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // Histogram bucket 0 counts 0, bucket n counts [2^(n-1), 2^n)
+    static constexpr size_t us_BucketCount = 32;
+    
+    // @NOTE: Layout is read by external tools, change u32_Version on change
+    struct MetricsPage
+    {
+        // Header
+        char p_Magic[8];
+        MRH_Uint32 u32_Version;
+        MRH_Uint32 u32_Size;
+        MRH_Uint32 u32_CounterCount;
+        MRH_Uint32 u32_GaugeCount;
+        MRH_Uint32 u32_HistogramCount;
+        MRH_Uint32 u32_BucketCount;
+        MRH_Uint32 u32_TransportCount;
+        MRH_Uint32 u32_TransportCounterCount;
+        MRH_Uint32 u32_ServiceCount;
+        MRH_Uint32 u32_ServiceGaugeCount;
+        MRH_Uint32 u32_ServiceNameSize;
+        MRH_Uint32 u32_Reserved; // Keeps u64_PID aligned
+        MRH_Uint64 u64_PID;
+        
+        // Values
+        std::atomic<MRH_Uint64> p_Counter[COUNTER_COUNT];
+        std::atomic<MRH_Uint64> p_Gauge[GAUGE_COUNT];
+        std::atomic<MRH_Uint64> p_Histogram[HISTOGRAM_COUNT][us_BucketCount];
+        std::atomic<MRH_Uint64> p_Transport[us_TransportCount][TRANSPORT_COUNTER_COUNT];
+        std::atomic<MRH_Uint64> p_ServiceGauge[us_ServiceCount][SERVICE_GAUGE_COUNT];
+        
+        // Service package names, empty for unused sets
+        char p_ServiceName[us_ServiceCount][us_ServiceNameSize];
+    };
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     */
+    
+    Metrics() noexcept;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~Metrics() noexcept;
+    
+    //*************************************************************************************
+    // Page
+    //*************************************************************************************
+    
+    /**
+     *  Set the page header and reset all values.
+     *
+     *  \param p_Target The page to set up.
+     */
+    
+    static void InitPage(MetricsPage* p_Target) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Active page, process memory or shared memory
+    MetricsPage* p_Page;
+    MetricsPage c_LocalPage;
+    
+    // Service gauge sets in use
+    std::atomic<size_t> us_ServiceUsed;
+    
+    // Shared memory
+    std::string s_PageName;
+
+protected:
+
+};
+
+#endif /* Metrics_h */
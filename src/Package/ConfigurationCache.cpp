@@ -0,0 +1,274 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// External
+
+// Project
+#include "./ConfigurationCache.h"
+#include "./PackagePaths.h"
+
+// Pre-defined
+namespace
+{
+    // Cache identification
+    const char p_Magic[8] = { 'M', 'R', 'H', 'U', 'S', 'C', 'F', 'G' };
+    
+    // @NOTE: Bump on any change to the cached values or the way they are 
+    //        parsed, old caches are parsed again
+    constexpr MRH_Uint32 u32_Version = 6;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+ConfigurationCache::ConfigurationCache(std::string const& s_PackagePath) noexcept : p_File(NULL)
+{
+    std::memset(&c_PackageKey, 0, sizeof(c_PackageKey));
+    std::memset(&c_LocaleKey, 0, sizeof(c_LocaleKey));
+    
+    try
+    {
+        s_CachePath = s_PackagePath + PACKAGE_CONFIGURATION_CACHE_PATH;
+        s_PackageFilePath = s_PackagePath + PACKAGE_CONFIGURATION_PATH;
+    }
+    catch (...)
+    {
+        return;
+    }
+    
+    int i_FD = open(s_CachePath.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    // Only trust caches written by this user, the cache sets the service 
+    // user and group
+    struct stat c_Stat;
+    
+    if (fstat(i_FD, &c_Stat) < 0 ||
+        S_ISREG(c_Stat.st_mode) == false ||
+        c_Stat.st_uid != geteuid() ||
+        (c_Stat.st_mode & (S_IWGRP | S_IWOTH)) != 0 ||
+        static_cast<size_t>(c_Stat.st_size) != sizeof(CacheFile))
+    {
+        close(i_FD);
+        return;
+    }
+    
+    void* p_Map = mmap(NULL, sizeof(CacheFile), PROT_READ, MAP_PRIVATE, i_FD, 0);
+    close(i_FD);
+    
+    if (p_Map == MAP_FAILED)
+    {
+        return;
+    }
+    
+    p_File = static_cast<const CacheFile*>(p_Map);
+    
+    if (std::memcmp(p_File->p_Magic, p_Magic, sizeof(p_Magic)) != 0 ||
+        p_File->u32_Version != u32_Version ||
+        p_File->u32_Size != sizeof(CacheFile))
+    {
+        munmap(p_Map, sizeof(CacheFile));
+        p_File = NULL;
+    }
+}
+
+ConfigurationCache::~ConfigurationCache() noexcept
+{
+    if (p_File != NULL)
+    {
+        munmap(const_cast<CacheFile*>(p_File), sizeof(CacheFile));
+    }
+}
+
+//*************************************************************************************
+// Package
+//*************************************************************************************
+
+bool ConfigurationCache::GetPackageValues(PackageValues& c_Values) noexcept
+{
+    // Taken before parsing, a change while parsing invalidates the stored values
+    if (GetSourceKey(s_PackageFilePath.c_str(), c_PackageKey) == false)
+    {
+        return false;
+    }
+    
+    if (p_File == NULL || CompareSourceKey(p_File->c_PackageKey, c_PackageKey) == false)
+    {
+        return false;
+    }
+    
+    c_Values = p_File->c_Package;
+    return true;
+}
+
+void ConfigurationCache::SetPackageValues(PackageValues const& c_Values) noexcept
+{
+    if (c_PackageKey.u64_Inode == 0)
+    {
+        return;
+    }
+    
+    CacheFile c_File;
+    GetContent(c_File);
+    
+    c_File.c_PackageKey = c_PackageKey;
+    c_File.c_Package = c_Values;
+    
+    Write(c_File);
+}
+
+//*************************************************************************************
+// Locale
+//*************************************************************************************
+
+bool ConfigurationCache::GetLocale(const char* p_LocaleFilePath, std::string& s_Locale) noexcept
+{
+    if (GetSourceKey(p_LocaleFilePath, c_LocaleKey) == false)
+    {
+        return false;
+    }
+    
+    if (p_File == NULL || CompareSourceKey(p_File->c_LocaleKey, c_LocaleKey) == false)
+    {
+        return false;
+    }
+    
+    try
+    {
+        s_Locale.assign(p_File->p_Locale, strnlen(p_File->p_Locale, sizeof(p_File->p_Locale)));
+    }
+    catch (...)
+    {
+        return false;
+    }
+    
+    return true;
+}
+
+void ConfigurationCache::SetLocale(std::string const& s_Locale) noexcept
+{
+    CacheFile c_File;
+    
+    // Locales which do not fit are parsed on each start
+    if (c_LocaleKey.u64_Inode == 0 || s_Locale.size() >= sizeof(c_File.p_Locale))
+    {
+        return;
+    }
+    
+    GetContent(c_File);
+    
+    c_File.c_LocaleKey = c_LocaleKey;
+    std::memset(c_File.p_Locale, '\0', sizeof(c_File.p_Locale));
+    std::memcpy(c_File.p_Locale, s_Locale.c_str(), s_Locale.size());
+    
+    Write(c_File);
+}
+
+//*************************************************************************************
+// Source
+//*************************************************************************************
+
+bool ConfigurationCache::GetSourceKey(const char* p_FilePath, SourceKey& c_Key) noexcept
+{
+    struct stat c_Stat;
+    
+    std::memset(&c_Key, 0, sizeof(c_Key));
+    
+    if (stat(p_FilePath, &c_Stat) < 0 || c_Stat.st_ino == 0)
+    {
+        return false;
+    }
+    
+    // The change time catches modifications with a restored modification time
+    c_Key.u64_Device = static_cast<MRH_Uint64>(c_Stat.st_dev);
+    c_Key.u64_Inode = static_cast<MRH_Uint64>(c_Stat.st_ino);
+    c_Key.u64_Size = static_cast<MRH_Uint64>(c_Stat.st_size);
+    c_Key.u64_ModifiedNS = static_cast<MRH_Uint64>(c_Stat.st_mtim.tv_sec) * 1000000000 + static_cast<MRH_Uint64>(c_Stat.st_mtim.tv_nsec);
+    c_Key.u64_ChangedNS = static_cast<MRH_Uint64>(c_Stat.st_ctim.tv_sec) * 1000000000 + static_cast<MRH_Uint64>(c_Stat.st_ctim.tv_nsec);
+    
+    return true;
+}
+
+bool ConfigurationCache::CompareSourceKey(SourceKey const& c_A, SourceKey const& c_B) noexcept
+{
+    return c_A.u64_Inode != 0 && std::memcmp(&c_A, &c_B, sizeof(SourceKey)) == 0;
+}
+
+//*************************************************************************************
+// Write
+//*************************************************************************************
+
+void ConfigurationCache::GetContent(CacheFile& c_File) const noexcept
+{
+    // Keep the other section if still valid
+    if (p_File != NULL)
+    {
+        c_File = *p_File;
+        return;
+    }
+    
+    std::memset(&c_File, 0, sizeof(CacheFile));
+    std::memcpy(c_File.p_Magic, p_Magic, sizeof(p_Magic));
+    c_File.u32_Version = u32_Version;
+    c_File.u32_Size = sizeof(CacheFile);
+}
+
+void ConfigurationCache::Write(CacheFile const& c_File) noexcept
+{
+    std::vector<char> v_TempPath;
+    
+    try
+    {
+        std::string s_TempPath(s_CachePath + ".XXXXXX");
+        v_TempPath.assign(s_TempPath.begin(), s_TempPath.end());
+        v_TempPath.emplace_back('\0');
+    }
+    catch (...)
+    {
+        return;
+    }
+    
+    // The package might be read-only, the cache is simply not used then
+    int i_FD = mkostemp(v_TempPath.data(), O_CLOEXEC);
+    
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    bool b_Written = fchmod(i_FD, 0644) == 0 && write(i_FD, &c_File, sizeof(CacheFile)) == static_cast<ssize_t>(sizeof(CacheFile));
+    
+    if (close(i_FD) < 0 || b_Written == false || rename(v_TempPath.data(), s_CachePath.c_str()) < 0)
+    {
+        unlink(v_TempPath.data());
+    }
+}
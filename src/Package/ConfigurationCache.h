@@ -0,0 +1,256 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef ConfigurationCache_h
+#define ConfigurationCache_h
+
+// C / C++
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+
+class ConfigurationCache
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // Event lists held by the cache, larger lists are not cached
+    static constexpr size_t us_MaxEventQuotaCount = 16;
+    static constexpr size_t us_MaxEventPriorityCount = 16;
+    
+    struct PackageValues
+    {
+        // Event Version
+        MRH_Sint32 s32_EventVersion;
+        
+        // Run As
+        MRH_Sint32 s32_UserID;
+        MRH_Sint32 s32_GroupID;
+        
+        // App Service
+        MRH_Uint32 u32_UpdateTimerS;
+        
+        // Events
+        MRH_Uint32 u32_SenderThread;
+        MRH_Uint32 u32_DrainDeadlineMS;
+        MRH_Uint32 u32_CoalesceEvents;
+        MRH_Uint32 u32_CoalesceBytes;
+        MRH_Uint32 u32_CoalesceDelayUS;
+        MRH_Uint32 u32_EventLimitMin;
+        MRH_Uint32 u32_EventLimitMax;
+        
+        // Watchdog
+        MRH_Uint32 u32_WatchdogSoftLimitMS;
+        MRH_Uint32 u32_WatchdogHardLimitMS;
+        
+        // Profiling
+        MRH_Uint32 u32_Profiling;
+        MRH_Uint32 u32_ProfileFileSizeKB;
+        
+        // Loading
+        MRH_Uint32 u32_LazyBinding;
+        MRH_Uint32 u32_Preload;
+        
+        // Event Quota
+        MRH_Uint32 u32_EventQuotaCount;
+        MRH_Uint32 p_EventQuotaType[us_MaxEventQuotaCount];
+        MRH_Uint32 p_EventQuotaRatePerS[us_MaxEventQuotaCount];
+        MRH_Uint32 p_EventQuotaBurst[us_MaxEventQuotaCount];
+        
+        // Event Priority
+        MRH_Uint32 u32_EventPriorityCount;
+        MRH_Uint32 p_EventPriorityType[us_MaxEventPriorityCount];
+        MRH_Uint32 p_EventPriority[us_MaxEventPriorityCount];
+    };
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. The cache file of the package is mapped if valid.
+     *
+     *  \param s_PackagePath The full path to the package, ending with a '/'.
+     */
+    
+    ConfigurationCache(std::string const& s_PackagePath) noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_ConfigurationCache ConfigurationCache class source.
+     */
+    
+    ConfigurationCache(ConfigurationCache const& c_ConfigurationCache) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~ConfigurationCache() noexcept;
+    
+    //*************************************************************************************
+    // Package
+    //*************************************************************************************
+    
+    /**
+     *  Get the cached package configuration values. The values are only returned if 
+     *  the package configuration file is unchanged.
+     *
+     *  \param c_Values The values to write to.
+     *
+     *  \return true if the cached values were returned, false if not.
+     */
+    
+    bool GetPackageValues(PackageValues& c_Values) noexcept;
+    
+    /**
+     *  Store package configuration values. The values are stored for the package 
+     *  configuration file state seen by the last GetPackageValues() call.
+     *
+     *  \param c_Values The parsed values.
+     */
+    
+    void SetPackageValues(PackageValues const& c_Values) noexcept;
+    
+    //*************************************************************************************
+    // Locale
+    //*************************************************************************************
+    
+    /**
+     *  Get the cached locale. The locale is only returned if the locale file is 
+     *  unchanged.
+     *
+     *  \param p_LocaleFilePath The full path to the locale file.
+     *  \param s_Locale The string to write the locale to.
+     *
+     *  \return true if the cached locale was returned, false if not.
+     */
+    
+    bool GetLocale(const char* p_LocaleFilePath, std::string& s_Locale) noexcept;
+    
+    /**
+     *  Store the locale. The locale is stored for the locale file state seen by 
+     *  the last GetLocale() call.
+     *
+     *  \param s_Locale The locale read from the locale file.
+     */
+    
+    void SetLocale(std::string const& s_Locale) noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct SourceKey
+    {
+        MRH_Uint64 u64_Device;
+        MRH_Uint64 u64_Inode;
+        MRH_Uint64 u64_Size;
+        MRH_Uint64 u64_ModifiedNS;
+        MRH_Uint64 u64_ChangedNS;
+    };
+    
+    struct CacheFile
+    {
+        // Identification
+        char p_Magic[8]; // "MRHUSCFG"
+        MRH_Uint32 u32_Version;
+        MRH_Uint32 u32_Size;
+        
+        // Package configuration, valid if the key is set
+        SourceKey c_PackageKey;
+        PackageValues c_Package;
+        
+        // Locale file, valid if the key is set
+        SourceKey c_LocaleKey;
+        char p_Locale[64];
+    };
+    
+    //*************************************************************************************
+    // Source
+    //*************************************************************************************
+    
+    /**
+     *  Get the key of a source file.
+     *
+     *  \param p_FilePath The full source file path.
+     *  \param c_Key The key to write to.
+     *
+     *  \return true on success, false on failure.
+     */
+    
+    static bool GetSourceKey(const char* p_FilePath, SourceKey& c_Key) noexcept;
+    
+    /**
+     *  Check if two source keys match.
+     *
+     *  \param c_A The first key.
+     *  \param c_B The second key.
+     *
+     *  \return true if the keys match, false if not.
+     */
+    
+    static bool CompareSourceKey(SourceKey const& c_A, SourceKey const& c_B) noexcept;
+    
+    //*************************************************************************************
+    // Write
+    //*************************************************************************************
+    
+    /**
+     *  Write the cache file. The file is replaced atomically.
+     *
+     *  \param c_File The cache file content.
+     */
+    
+    void Write(CacheFile const& c_File) noexcept;
+    
+    /**
+     *  Get the current cache file content to update.
+     *
+     *  \param c_File The cache file content to write to.
+     */
+    
+    void GetContent(CacheFile& c_File) const noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Cache file
+    std::string s_CachePath;
+    std::string s_PackageFilePath;
+    const CacheFile* p_File; // NULL if missing or invalid
+    
+    // Source state of the last lookup, invalid if the inode is 0
+    SourceKey c_PackageKey;
+    SourceKey c_LocaleKey;
+
+protected:
+
+};
+
+#endif /* ConfigurationCache_h */
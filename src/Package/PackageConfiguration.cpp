@@ -24,6 +24,7 @@
 
 // Project
 #include "./PackageConfiguration.h"
+#include "./ConfigurationCache.h"
 #include "./PackagePaths.h"
 
 // Pre-defined
@@ -35,19 +36,55 @@ namespace
         BLOCK_EVENT_VERSION = 0,
         BLOCK_RUN_AS = 1,
         BLOCK_APP_SERVICE = 2,
+        BLOCK_EVENTS = 3,
+        BLOCK_WATCHDOG = 4,
+        BLOCK_PROFILING = 5,
+        BLOCK_LOADING = 6,
+        BLOCK_EVENT_QUOTA = 7,
+        BLOCK_EVENT_PRIORITY = 8,
 
         // Event Version Key
-        KEY_EVENT_VERSION_SERVICE = 3,
+        KEY_EVENT_VERSION_SERVICE = 9,
 
         // Run As Key
-        KEY_RUN_AS_USER_ID = 4,
-        KEY_RUN_AS_GROUP_ID = 5,
+        KEY_RUN_AS_USER_ID = 10,
+        KEY_RUN_AS_GROUP_ID = 11,
         
         // App Service Key
-        KEY_APP_SERVICE_UPDATE_TIMER,
+        KEY_APP_SERVICE_UPDATE_TIMER = 12,
+        
+        // Events Key
+        KEY_EVENTS_SENDER_THREAD = 13,
+        KEY_EVENTS_DRAIN_DEADLINE_MS = 14,
+        KEY_EVENTS_COALESCE_EVENTS = 15,
+        KEY_EVENTS_COALESCE_BYTES = 16,
+        KEY_EVENTS_COALESCE_DELAY_US = 17,
+        KEY_EVENTS_EVENT_LIMIT_MIN = 18,
+        KEY_EVENTS_EVENT_LIMIT_MAX = 19,
+        
+        // Watchdog Key
+        KEY_WATCHDOG_SOFT_LIMIT_MS = 20,
+        KEY_WATCHDOG_HARD_LIMIT_MS = 21,
+        
+        // Profiling Key
+        KEY_PROFILING_ENABLED = 22,
+        KEY_PROFILING_FILE_SIZE_KB = 23,
+        
+        // Loading Key
+        KEY_LOADING_LAZY_BINDING = 24,
+        KEY_LOADING_PRELOAD = 25,
+        
+        // Event Quota Key
+        KEY_EVENT_QUOTA_TYPE = 26,
+        KEY_EVENT_QUOTA_RATE_PER_S = 27,
+        KEY_EVENT_QUOTA_BURST = 28,
+        
+        // Event Priority Key
+        KEY_EVENT_PRIORITY_TYPE = 29,
+        KEY_EVENT_PRIORITY_PRIORITY = 30,
 
         // Bounds
-        IDENTIFIER_MAX = KEY_APP_SERVICE_UPDATE_TIMER,
+        IDENTIFIER_MAX = KEY_EVENT_PRIORITY_PRIORITY,
 
         IDENTIFIER_COUNT = IDENTIFIER_MAX + 1
     };
@@ -58,19 +95,64 @@ namespace
         "EventVersion",
         "RunAs",
         "AppService",
+        "Events",
+        "Watchdog",
+        "Profiling",
+        "Loading",
+        "EventQuota",
+        "EventPriority",
 
         // Event Version Key
         "AppService",
 
         // Run As Key
         "UserID",
-        "GroupID"
+        "GroupID",
     
         // App Service Key
-        "UpdateTimerS"
+        "UpdateTimerS",
+        
+        // Events Key
+        "SenderThread",
+        "DrainDeadlineMS",
+        "CoalesceEvents",
+        "CoalesceBytes",
+        "CoalesceDelayUS",
+        "EventLimitMin",
+        "EventLimitMax",
+        
+        // Watchdog Key
+        "SoftLimitMS",
+        "HardLimitMS",
+        
+        // Profiling Key
+        "Enabled",
+        "FileSizeKB",
+        
+        // Loading Key
+        "LazyBinding",
+        "Preload",
+        
+        // Event Quota Key
+        "Type",
+        "RatePerS",
+        "Burst",
+        
+        // Event Priority Key
+        "Type",
+        "Priority"
     };
 
     constexpr MRH_Uint32 u32_MinUpdateTimerS = 300; // 5 Min
+    
+    // Remaining events are dropped after the deadline on exit
+    constexpr MRH_Uint32 u32_DefaultDrainDeadlineMS = 5000;
+    
+    // Profile file size before rolling over
+    constexpr MRH_Uint32 u32_DefaultProfileFileSizeKB = 1024;
+    
+    // Lowest event priority, higher values are lowered
+    constexpr MRH_Uint32 u32_MaxEventPriority = 2;
 
     // Event version bounds
     constexpr int i_EventVerMin = 1;
@@ -84,7 +166,20 @@ namespace
 
 PackageConfiguration::PackageConfiguration(std::string s_PackagePath) : i_UserID(-1),
                                                                         i_GroupID(-1),
-                                                                        u32_UpdateTimerS(u32_MinUpdateTimerS)
+                                                                        u32_UpdateTimerS(u32_MinUpdateTimerS),
+                                                                        b_SenderThread(false),
+                                                                        u32_DrainDeadlineMS(u32_DefaultDrainDeadlineMS),
+                                                                        u32_CoalesceEvents(0),
+                                                                        u32_CoalesceBytes(0),
+                                                                        u32_CoalesceDelayUS(0),
+                                                                        u32_EventLimitMin(0),
+                                                                        u32_EventLimitMax(0),
+                                                                        u32_WatchdogSoftLimitMS(0),
+                                                                        u32_WatchdogHardLimitMS(0),
+                                                                        b_Profiling(false),
+                                                                        u32_ProfileFileSizeKB(u32_DefaultProfileFileSizeKB),
+                                                                        b_LazyBinding(false),
+                                                                        b_Preload(true)
 {
     // Get configuration values
     if (*(s_PackagePath.end() - 1) != '/')
@@ -92,8 +187,113 @@ PackageConfiguration::PackageConfiguration(std::string s_PackagePath) : i_UserID
         s_PackagePath += "/";
     }
     
+    // Unchanged configurations are read from the cache
+    ConfigurationCache c_Cache(s_PackagePath);
+    ConfigurationCache::PackageValues c_Values;
+    
+    if (c_Cache.GetPackageValues(c_Values) == true)
+    {
+        i_UserID = c_Values.s32_UserID;
+        i_GroupID = c_Values.s32_GroupID;
+        u32_UpdateTimerS = c_Values.u32_UpdateTimerS;
+        b_SenderThread = c_Values.u32_SenderThread != 0;
+        u32_DrainDeadlineMS = c_Values.u32_DrainDeadlineMS;
+        u32_CoalesceEvents = c_Values.u32_CoalesceEvents;
+        u32_CoalesceBytes = c_Values.u32_CoalesceBytes;
+        u32_CoalesceDelayUS = c_Values.u32_CoalesceDelayUS;
+        u32_EventLimitMin = c_Values.u32_EventLimitMin;
+        u32_EventLimitMax = c_Values.u32_EventLimitMax;
+        u32_WatchdogSoftLimitMS = c_Values.u32_WatchdogSoftLimitMS;
+        u32_WatchdogHardLimitMS = c_Values.u32_WatchdogHardLimitMS;
+        b_Profiling = c_Values.u32_Profiling != 0;
+        u32_ProfileFileSizeKB = c_Values.u32_ProfileFileSizeKB;
+        b_LazyBinding = c_Values.u32_LazyBinding != 0;
+        b_Preload = c_Values.u32_Preload != 0;
+        
+        for (MRH_Uint32 i = 0; i < c_Values.u32_EventQuotaCount && i < ConfigurationCache::us_MaxEventQuotaCount; ++i)
+        {
+            v_EventQuota.push_back({ c_Values.p_EventQuotaType[i], c_Values.p_EventQuotaRatePerS[i], c_Values.p_EventQuotaBurst[i] });
+        }
+        
+        for (MRH_Uint32 i = 0; i < c_Values.u32_EventPriorityCount && i < ConfigurationCache::us_MaxEventPriorityCount; ++i)
+        {
+            v_EventPriority.push_back({ c_Values.p_EventPriorityType[i], c_Values.p_EventPriority[i] });
+        }
+        
+        CheckEventVersion(c_Values.s32_EventVersion);
+        return;
+    }
+    
+    c_Values.s32_EventVersion = ReadFile(s_PackagePath);
+    CheckEventVersion(c_Values.s32_EventVersion);
+    
+    c_Values.s32_UserID = i_UserID;
+    c_Values.s32_GroupID = i_GroupID;
+    c_Values.u32_UpdateTimerS = u32_UpdateTimerS;
+    c_Values.u32_SenderThread = b_SenderThread == true ? 1 : 0;
+    c_Values.u32_DrainDeadlineMS = u32_DrainDeadlineMS;
+    c_Values.u32_CoalesceEvents = u32_CoalesceEvents;
+    c_Values.u32_CoalesceBytes = u32_CoalesceBytes;
+    c_Values.u32_CoalesceDelayUS = u32_CoalesceDelayUS;
+    c_Values.u32_EventLimitMin = u32_EventLimitMin;
+    c_Values.u32_EventLimitMax = u32_EventLimitMax;
+    c_Values.u32_WatchdogSoftLimitMS = u32_WatchdogSoftLimitMS;
+    c_Values.u32_WatchdogHardLimitMS = u32_WatchdogHardLimitMS;
+    c_Values.u32_Profiling = b_Profiling == true ? 1 : 0;
+    c_Values.u32_ProfileFileSizeKB = u32_ProfileFileSizeKB;
+    c_Values.u32_LazyBinding = b_LazyBinding == true ? 1 : 0;
+    c_Values.u32_Preload = b_Preload == true ? 1 : 0;
+    c_Values.u32_EventQuotaCount = static_cast<MRH_Uint32>(v_EventQuota.size());
+    c_Values.u32_EventPriorityCount = static_cast<MRH_Uint32>(v_EventPriority.size());
+    
+    // Read again next time, the values do not fit the cache
+    if (v_EventQuota.size() > ConfigurationCache::us_MaxEventQuotaCount ||
+        v_EventPriority.size() > ConfigurationCache::us_MaxEventPriorityCount)
+    {
+        return;
+    }
+    
+    for (size_t i = 0; i < v_EventQuota.size(); ++i)
+    {
+        c_Values.p_EventQuotaType[i] = v_EventQuota[i].u32_Type;
+        c_Values.p_EventQuotaRatePerS[i] = v_EventQuota[i].u32_RatePerS;
+        c_Values.p_EventQuotaBurst[i] = v_EventQuota[i].u32_Burst;
+    }
+    
+    for (size_t i = 0; i < v_EventPriority.size(); ++i)
+    {
+        c_Values.p_EventPriorityType[i] = v_EventPriority[i].u32_Type;
+        c_Values.p_EventPriority[i] = v_EventPriority[i].u32_Priority;
+    }
+    
+    c_Cache.SetPackageValues(c_Values);
+}
+
+PackageConfiguration::~PackageConfiguration() noexcept
+{}
+
+//*************************************************************************************
+// Read
+//*************************************************************************************
+
+int PackageConfiguration::ReadFile(std::string const& s_PackagePath)
+{
     int i_EventVer = -1;
     
+    // Optional values keep their default if missing
+    auto GetOptionalValue = [](auto& Block, const char* p_Key, std::string const& s_Default) -> std::string
+    {
+        try
+        {
+            std::string s_Value(Block.GetValue(p_Key));
+            return s_Value.size() > 0 ? s_Value : s_Default;
+        }
+        catch (MRH_BFException& e)
+        {
+            return s_Default;
+        }
+    };
+    
     try
     {
         MRH_BlockFile c_File(s_PackagePath + std::string(PACKAGE_CONFIGURATION_PATH));
@@ -120,6 +320,62 @@ PackageConfiguration::PackageConfiguration(std::string s_PackagePath) : i_UserID
                     u32_UpdateTimerS = u32_MinUpdateTimerS;
                 }
             }
+            else if (s_Name.compare(p_Identifier[BLOCK_EVENTS]) == 0)
+            {
+                b_SenderThread = std::stoi(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_SENDER_THREAD], "0")) != 0;
+                u32_DrainDeadlineMS = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_DRAIN_DEADLINE_MS], std::to_string(u32_DefaultDrainDeadlineMS))));
+                u32_CoalesceEvents = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_COALESCE_EVENTS], "0")));
+                u32_CoalesceBytes = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_COALESCE_BYTES], "0")));
+                u32_CoalesceDelayUS = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_COALESCE_DELAY_US], "0")));
+                u32_EventLimitMin = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_EVENT_LIMIT_MIN], "0")));
+                u32_EventLimitMax = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENTS_EVENT_LIMIT_MAX], "0")));
+            }
+            else if (s_Name.compare(p_Identifier[BLOCK_WATCHDOG]) == 0)
+            {
+                u32_WatchdogSoftLimitMS = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_WATCHDOG_SOFT_LIMIT_MS], "0")));
+                u32_WatchdogHardLimitMS = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_WATCHDOG_HARD_LIMIT_MS], "0")));
+            }
+            else if (s_Name.compare(p_Identifier[BLOCK_PROFILING]) == 0)
+            {
+                b_Profiling = std::stoi(GetOptionalValue(Block, p_Identifier[KEY_PROFILING_ENABLED], "0")) != 0;
+                u32_ProfileFileSizeKB = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_PROFILING_FILE_SIZE_KB], std::to_string(u32_DefaultProfileFileSizeKB))));
+            }
+            else if (s_Name.compare(p_Identifier[BLOCK_LOADING]) == 0)
+            {
+                b_LazyBinding = std::stoi(GetOptionalValue(Block, p_Identifier[KEY_LOADING_LAZY_BINDING], "0")) != 0;
+                b_Preload = std::stoi(GetOptionalValue(Block, p_Identifier[KEY_LOADING_PRELOAD], "1")) != 0;
+            }
+            else if (s_Name.compare(p_Identifier[BLOCK_EVENT_QUOTA]) == 0)
+            {
+                // One block per event type, the burst defaults to a second of events
+                EventQuota c_Quota;
+                
+                c_Quota.u32_Type = static_cast<MRH_Uint32>(std::stoull(Block.GetValue(p_Identifier[KEY_EVENT_QUOTA_TYPE])));
+                c_Quota.u32_RatePerS = static_cast<MRH_Uint32>(std::stoull(Block.GetValue(p_Identifier[KEY_EVENT_QUOTA_RATE_PER_S])));
+                c_Quota.u32_Burst = static_cast<MRH_Uint32>(std::stoull(GetOptionalValue(Block, p_Identifier[KEY_EVENT_QUOTA_BURST], std::to_string(c_Quota.u32_RatePerS))));
+                
+                if (c_Quota.u32_Burst == 0)
+                {
+                    c_Quota.u32_Burst = 1;
+                }
+                
+                v_EventQuota.emplace_back(c_Quota);
+            }
+            else if (s_Name.compare(p_Identifier[BLOCK_EVENT_PRIORITY]) == 0)
+            {
+                // One block per event type, 0 is the highest priority
+                EventPriority c_Priority;
+                
+                c_Priority.u32_Type = static_cast<MRH_Uint32>(std::stoull(Block.GetValue(p_Identifier[KEY_EVENT_PRIORITY_TYPE])));
+                c_Priority.u32_Priority = static_cast<MRH_Uint32>(std::stoull(Block.GetValue(p_Identifier[KEY_EVENT_PRIORITY_PRIORITY])));
+                
+                if (c_Priority.u32_Priority > u32_MaxEventPriority)
+                {
+                    c_Priority.u32_Priority = u32_MaxEventPriority;
+                }
+                
+                v_EventPriority.emplace_back(c_Priority);
+            }
         }
     }
     catch (std::exception& e) // + MRH_BFException
@@ -127,6 +383,11 @@ PackageConfiguration::PackageConfiguration(std::string s_PackagePath) : i_UserID
         throw Exception("Could not read package configuration (" + std::string(e.what()) + ")!");
     }
     
+    return i_EventVer;
+}
+
+void PackageConfiguration::CheckEventVersion(int i_EventVer)
+{
     if (i_EventVer < i_EventVerMin || i_EventVer > i_EventVerMax)
     {
         throw Exception("Invalid app event version: Got " +
@@ -139,8 +400,29 @@ PackageConfiguration::PackageConfiguration(std::string s_PackagePath) : i_UserID
     }
 }
 
-PackageConfiguration::~PackageConfiguration() noexcept
-{}
+//*************************************************************************************
+// Package Name
+//*************************************************************************************
+
+std::string PackageConfiguration::GetPackageName(std::string const& s_PackagePath) noexcept
+{
+    size_t us_ExtPos = s_PackagePath.find_last_of(PACKAGE_EXTENSION);
+    
+    if (us_ExtPos == std::string::npos)
+    {
+        return "unknown";
+    }
+    
+    us_ExtPos += std::strlen(PACKAGE_EXTENSION);
+    size_t us_SlashPos = s_PackagePath.find_last_of("/", us_ExtPos);
+    
+    if (us_SlashPos == std::string::npos)
+    {
+        us_SlashPos = 0;
+    }
+    
+    return s_PackagePath.substr(us_SlashPos, us_ExtPos);
+}
 
 //*************************************************************************************
 // Getters
@@ -160,3 +442,78 @@ MRH_Uint32 PackageConfiguration::GetUpdateTimerS() const noexcept
 {
     return u32_UpdateTimerS;
 }
+
+bool PackageConfiguration::GetSenderThread() const noexcept
+{
+    return b_SenderThread;
+}
+
+MRH_Uint32 PackageConfiguration::GetDrainDeadlineMS() const noexcept
+{
+    return u32_DrainDeadlineMS;
+}
+
+MRH_Uint32 PackageConfiguration::GetCoalesceEvents() const noexcept
+{
+    return u32_CoalesceEvents;
+}
+
+MRH_Uint32 PackageConfiguration::GetCoalesceBytes() const noexcept
+{
+    return u32_CoalesceBytes;
+}
+
+MRH_Uint32 PackageConfiguration::GetCoalesceDelayUS() const noexcept
+{
+    return u32_CoalesceDelayUS;
+}
+
+MRH_Uint32 PackageConfiguration::GetEventLimitMin() const noexcept
+{
+    return u32_EventLimitMin;
+}
+
+MRH_Uint32 PackageConfiguration::GetEventLimitMax() const noexcept
+{
+    return u32_EventLimitMax;
+}
+
+MRH_Uint32 PackageConfiguration::GetWatchdogSoftLimitMS() const noexcept
+{
+    return u32_WatchdogSoftLimitMS;
+}
+
+MRH_Uint32 PackageConfiguration::GetWatchdogHardLimitMS() const noexcept
+{
+    return u32_WatchdogHardLimitMS;
+}
+
+bool PackageConfiguration::GetProfiling() const noexcept
+{
+    return b_Profiling;
+}
+
+MRH_Uint32 PackageConfiguration::GetProfileFileSizeKB() const noexcept
+{
+    return u32_ProfileFileSizeKB;
+}
+
+bool PackageConfiguration::GetLazyBinding() const noexcept
+{
+    return b_LazyBinding;
+}
+
+bool PackageConfiguration::GetPreload() const noexcept
+{
+    return b_Preload;
+}
+
+std::vector<PackageConfiguration::EventQuota> const& PackageConfiguration::GetEventQuotas() const noexcept
+{
+    return v_EventQuota;
+}
+
+std::vector<PackageConfiguration::EventPriority> const& PackageConfiguration::GetEventPriorities() const noexcept
+{
+    return v_EventPriority;
+}
@@ -18,6 +18,8 @@
 #define PackageConfiguration_h
 
 // C / C++
+#include <string>
+#include <vector>
 
 // External
 #include <MRH_Typedefs.h>
@@ -30,6 +32,37 @@ class PackageConfiguration
 {
 public:
     
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct EventQuota
+    {
+        MRH_Uint32 u32_Type;
+        MRH_Uint32 u32_RatePerS;
+        MRH_Uint32 u32_Burst;
+    };
+    
+    struct EventPriority
+    {
+        MRH_Uint32 u32_Type;
+        MRH_Uint32 u32_Priority; // 0 (High) to 2 (Low)
+    };
+    
+    //*************************************************************************************
+    // Package Name
+    //*************************************************************************************
+    
+    /**
+     *  Get the package name used for the log, metrics and profile names.
+     *
+     *  \param s_PackagePath The full path to the application package.
+     *
+     *  \return The package name.
+     */
+    
+    static std::string GetPackageName(std::string const& s_PackagePath) noexcept;
+    
     //*************************************************************************************
     // Getters
     //*************************************************************************************
@@ -57,9 +90,152 @@ public:
      */
     
     MRH_Uint32 GetUpdateTimerS() const noexcept;
+    
+    /**
+     *  Check if events should be sent on a dedicated sender thread.
+     *
+     *  \return true if a sender thread should be used, false if not.
+     */
+    
+    bool GetSenderThread() const noexcept;
+    
+    /**
+     *  Get the max time to wait for remaining events on exit.
+     *
+     *  \return The drain deadline in milliseconds.
+     */
+    
+    MRH_Uint32 GetDrainDeadlineMS() const noexcept;
+    
+    /**
+     *  Get the amount of events which are sent at once when coalescing.
+     *
+     *  \return The event threshold, 0 if unused.
+     */
+    
+    MRH_Uint32 GetCoalesceEvents() const noexcept;
+    
+    /**
+     *  Get the amount of event data which is sent at once when coalescing.
+     *
+     *  \return The byte threshold, 0 if unused.
+     */
+    
+    MRH_Uint32 GetCoalesceBytes() const noexcept;
+    
+    /**
+     *  Get the max time events are held back for coalescing.
+     *
+     *  \return The max delay in microseconds, 0 if coalescing is disabled.
+     */
+    
+    MRH_Uint32 GetCoalesceDelayUS() const noexcept;
+    
+    /**
+     *  Get the lowest event limit the adaptive event limit can reach.
+     *
+     *  \return The min event limit, 0 if not set.
+     */
+    
+    MRH_Uint32 GetEventLimitMin() const noexcept;
+    
+    /**
+     *  Get the highest event limit the adaptive event limit can reach.
+     *
+     *  \return The max event limit, 0 if not set.
+     */
+    
+    MRH_Uint32 GetEventLimitMax() const noexcept;
+    
+    /**
+     *  Get the service callback time before the watchdog takes a stack sample.
+     *
+     *  \return The soft limit in milliseconds, 0 if disabled.
+     */
+    
+    MRH_Uint32 GetWatchdogSoftLimitMS() const noexcept;
+    
+    /**
+     *  Get the service callback time before the watchdog aborts the process.
+     *
+     *  \return The hard limit in milliseconds, 0 if disabled.
+     */
+    
+    MRH_Uint32 GetWatchdogHardLimitMS() const noexcept;
+    
+    /**
+     *  Check if service callbacks should be profiled.
+     *
+     *  \return true if profiling is enabled, false if not.
+     */
+    
+    bool GetProfiling() const noexcept;
+    
+    /**
+     *  Get the profile file size before the file is rolled over.
+     *
+     *  \return The profile file size in kilobytes.
+     */
+    
+    MRH_Uint32 GetProfileFileSizeKB() const noexcept;
+    
+    /**
+     *  Check if service symbols should be resolved on first use instead of on 
+     *  load.
+     *
+     *  \return true for lazy binding, false if not.
+     */
+    
+    bool GetLazyBinding() const noexcept;
+    
+    /**
+     *  Check if the service shared object should be read ahead during setup.
+     *
+     *  \return true if preloading, false if not.
+     */
+    
+    bool GetPreload() const noexcept;
+    
+    /**
+     *  Get the token bucket quotas for recieved event types.
+     *
+     *  \return The event quotas, one per event type.
+     */
+    
+    std::vector<EventQuota> const& GetEventQuotas() const noexcept;
+    
+    /**
+     *  Get the send priorities for recieved event types.
+     *
+     *  \return The event priorities, one per event type.
+     */
+    
+    std::vector<EventPriority> const& GetEventPriorities() const noexcept;
 
 private:
 
+    //*************************************************************************************
+    // Read
+    //*************************************************************************************
+    
+    /**
+     *  Read the values from the package configuration file.
+     *
+     *  \param s_PackagePath The path to the package, ending with a '/'.
+     *
+     *  \return The event version of the service.
+     */
+    
+    int ReadFile(std::string const& s_PackagePath);
+    
+    /**
+     *  Check if a event version is supported.
+     *
+     *  \param i_EventVer The event version to check.
+     */
+    
+    void CheckEventVersion(int i_EventVer);
+
     //*************************************************************************************
     // Data
     //*************************************************************************************
@@ -71,6 +247,33 @@ private:
     // Timers
     MRH_Uint32 u32_UpdateTimerS;
     
+    // Events
+    bool b_SenderThread;
+    MRH_Uint32 u32_DrainDeadlineMS;
+    MRH_Uint32 u32_CoalesceEvents;
+    MRH_Uint32 u32_CoalesceBytes;
+    MRH_Uint32 u32_CoalesceDelayUS;
+    MRH_Uint32 u32_EventLimitMin;
+    MRH_Uint32 u32_EventLimitMax;
+    
+    // Watchdog
+    MRH_Uint32 u32_WatchdogSoftLimitMS;
+    MRH_Uint32 u32_WatchdogHardLimitMS;
+    
+    // Profiling
+    bool b_Profiling;
+    MRH_Uint32 u32_ProfileFileSizeKB;
+    
+    // Loading
+    bool b_LazyBinding;
+    bool b_Preload;
+    
+    // Event Quota
+    std::vector<EventQuota> v_EventQuota;
+    
+    // Event Priority
+    std::vector<EventPriority> v_EventPriority;
+
 protected:
 
     //*************************************************************************************
@@ -39,6 +39,7 @@
 
 // Configuration
 #define PACKAGE_CONFIGURATION_PATH "Configuration.conf" // <Package Path><"Configuration">
+#define PACKAGE_CONFIGURATION_CACHE_PATH "Configuration.cache" // <Package Path><"Configuration.cache">
 
 
 #endif /* PackagePaths_h */
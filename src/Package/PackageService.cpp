@@ -16,9 +16,11 @@
 
 // C / C++
 #include <unistd.h>
+#include <fcntl.h>
 #include <dlfcn.h>
 #include <sys/types.h>
 #include <cstring>
+#include <cerrno>
 #include <new>
 
 // External
@@ -26,7 +28,9 @@
 // Project
 #include "./PackageService.h"
 #include "./PackagePaths.h"
+#include "../Event/EventPool.h"
 #include "../Logger.h"
+#include "../Metrics.h"
 
 namespace
 {
@@ -35,6 +39,11 @@ namespace
     const char* p_FunctionUpdateName = "MRH_Update";
     const char* p_FunctionSendEventName = "MRH_SendEvent";
     const char* p_FunctionExitName = "MRH_Exit";
+    
+    // Optional shared object function names
+    const char* p_FunctionSetEventNotifyName = "MRH_SetEventNotify";
+    const char* p_FunctionSetEventPoolName = "MRH_SetEventPool";
+    const char* p_FunctionSendEventBatchName = "MRH_SendEventBatch";
 }
 
 
@@ -52,8 +61,18 @@ PackageService::PackageService(const char* p_PackagePath,
     p_FunctionUpdateLocation = NULL;
     p_FunctionSendEventLocation = NULL;
     p_FunctionExitLocation = NULL;
+    p_FunctionSetEventNotifyLocation = NULL;
+    p_FunctionSetEventPoolLocation = NULL;
+    p_FunctionSendEventBatchLocation = NULL;
     p_ServiceEventContainer = NULL;
     u32_EventLimit = 1;
+    u32_MinEventLimit = 1;
+    u32_MaxEventLimit = 1;
+    b_EventLimitReached = false;
+    b_Congested = false;
+    us_MetricsService = Metrics::us_ServiceCount;
+    p_OutputTransport = NULL;
+    u64_OutputFull = 0;
     
     // Get shared object path
     if (p_PackagePath == NULL || std::strlen(p_PackagePath) == 0)
@@ -81,19 +100,81 @@ PackageService::PackageService(const char* p_PackagePath,
         throw Exception(std::string("Failed to set event limit: ") + e.what());
     }
     
+    // The given limit is the start value for configured bounds, fixed otherwise
+    u32_MinEventLimit = GetEventLimitMin() > 0 ? GetEventLimitMin() : (GetEventLimitMax() > 0 ? 1 : u32_EventLimit);
+    u32_MaxEventLimit = GetEventLimitMax() > 0 ? GetEventLimitMax() : (u32_EventLimit > u32_MinEventLimit ? u32_EventLimit : u32_MinEventLimit);
+    
+    if (u32_MaxEventLimit < u32_MinEventLimit)
+    {
+        u32_MaxEventLimit = u32_MinEventLimit;
+    }
+    
+    if (u32_EventLimit < u32_MinEventLimit)
+    {
+        u32_EventLimit = u32_MinEventLimit;
+    }
+    else if (u32_EventLimit > u32_MaxEventLimit)
+    {
+        u32_EventLimit = u32_MaxEventLimit;
+    }
+    
     // Create container last, used for event exchange
     try
     {
+        for (auto& Quota : GetEventQuotas())
+        {
+            c_RateLimiter.SetQuota(Quota.u32_Type, Quota.u32_RatePerS, Quota.u32_Burst);
+        }
+        
+        // Each hosted service has its own gauges
+        us_MetricsService = Metrics::Singleton().AddService(GetPackageName(p_PackagePath));
+        
         p_ServiceEventContainer = new ServiceEventContainer(u32_EventLimit);
+        p_ServiceEventContainer->SetLatency(true);
+        p_ServiceEventContainer->SetMetricsService(us_MetricsService);
+        
+        for (auto& Priority : GetEventPriorities())
+        {
+            p_ServiceEventContainer->SetPriority(Priority.u32_Type, static_cast<EventContainer::Priority>(Priority.u32_Priority));
+        }
     }
     catch (std::exception& e)
     {
+        delete p_ServiceEventContainer;
         throw Exception(std::string("Failed to construct event container: ") + e.what());
     }
+    
+    // Watched from the first callback on
+    Watchdog::InitWatch(c_Watch, p_PackagePath, GetWatchdogSoftLimitMS(), GetWatchdogHardLimitMS());
+    
+    try
+    {
+        Watchdog::Singleton().Add(&c_Watch);
+    }
+    catch (Exception&)
+    {
+        delete p_ServiceEventContainer;
+        throw;
+    }
+    
+    // Optional, the service runs without a profile file
+    if (GetProfiling() == true)
+    {
+        if (c_Profiler.Open(GetPackageName(p_PackagePath), GetProfileFileSizeKB()) == true)
+        {
+            MRH_LOG_INFO("Profile file: ", c_Profiler.GetFilePath());
+        }
+        else
+        {
+            MRH_LOG_WARNING("Failed to open profile file: ", std::strerror(errno));
+        }
+    }
 }
 
 PackageService::~PackageService() noexcept
 {
+    Watchdog::Singleton().Remove(&c_Watch);
+    
     if (p_ServiceEventContainer != NULL)
     {
         delete p_ServiceEventContainer;
@@ -115,12 +196,30 @@ PackageService::ServiceEventContainer::~ServiceEventContainer() noexcept
 // Load
 //*************************************************************************************
 
+bool PackageService::Preload() noexcept
+{
+    int i_FD = open(s_SharedObjectPath.c_str(), O_RDONLY | O_CLOEXEC);
+    
+    if (i_FD < 0)
+    {
+        return false;
+    }
+    
+    // @NOTE: Only the file is read, loading runs code of the service and has 
+    //        to wait for the user change
+    int i_Result = posix_fadvise(i_FD, 0, 0, POSIX_FADV_WILLNEED);
+    close(i_FD);
+    
+    return i_Result == 0;
+}
+
 void PackageService::LoadSharedObject()
 {
     // Clear dlerror, might still contain unrelated info
     dlerror();
     
-    if ((p_SharedObjectHandle = dlopen(s_SharedObjectPath.c_str(), RTLD_NOW)) == NULL)
+    // Lazy binding defers missing symbols to their first call
+    if ((p_SharedObjectHandle = dlopen(s_SharedObjectPath.c_str(), GetLazyBinding() == true ? RTLD_LAZY : RTLD_NOW)) == NULL)
     {
         throw Exception("Failed to load shared object " + s_SharedObjectPath + " (" + std::string(dlerror()) + ")!");
     }
@@ -138,6 +237,24 @@ void PackageService::LoadSharedObject()
     {
         throw Exception("Failed to load functions from " + s_SharedObjectPath + " (" + std::string(dlerror()) + ")!");
     }
+    
+    // Optional functions, missing ones are fine
+    p_FunctionSetEventNotifyLocation = dlsym(p_SharedObjectHandle, p_FunctionSetEventNotifyName);
+    p_FunctionSetEventPoolLocation = dlsym(p_SharedObjectHandle, p_FunctionSetEventPoolName);
+    
+    if ((p_FunctionSendEventBatchLocation = dlsym(p_SharedObjectHandle, p_FunctionSendEventBatchName)) != NULL)
+    {
+        try
+        {
+            v_EventBatch.resize(u32_MaxEventLimit, NULL);
+        }
+        catch (std::exception& e)
+        {
+            // Fall back to single events
+            p_FunctionSendEventBatchLocation = NULL;
+        }
+    }
+    dlerror();
 }
 
 //*************************************************************************************
@@ -149,12 +266,64 @@ void PackageService::Init()
     int (*FunctionInit)(void);
     FunctionInit = reinterpret_cast<int(*)(void)>(p_FunctionInitLocation);
     
-    if (FunctionInit() < 0)
+    c_Profiler.Enter(Watchdog::CALLBACK_INIT);
+    Watchdog::Enter(c_Watch, Watchdog::CALLBACK_INIT);
+    int i_Result = FunctionInit();
+    Watchdog::Leave(c_Watch);
+    c_Profiler.Leave();
+    
+    if (i_Result < 0)
     {
         throw Exception("Failed to run app service init function!");
     }
 }
 
+//*************************************************************************************
+// Notify
+//*************************************************************************************
+
+bool PackageService::SetEventNotify(void (*NotifyCallback)(void*), void* p_NotifyContext) noexcept
+{
+    if (p_FunctionSetEventNotifyLocation == NULL)
+    {
+        return false;
+    }
+    
+    void (*FunctionSetEventNotify)(void (*)(void*), void*);
+    FunctionSetEventNotify = reinterpret_cast<void(*)(void (*)(void*), void*)>(p_FunctionSetEventNotifyLocation);
+    
+    FunctionSetEventNotify(NotifyCallback, p_NotifyContext);
+    return true;
+}
+
+//*************************************************************************************
+// Event Pool
+//*************************************************************************************
+
+bool PackageService::SetEventPool(MRH_Event* (*AcquireCallback)(MRH_Uint32, MRH_Uint32), void (*ReleaseCallback)(MRH_Event*)) noexcept
+{
+    if (p_FunctionSetEventPoolLocation == NULL)
+    {
+        return false;
+    }
+    
+    void (*FunctionSetEventPool)(MRH_Event* (*)(MRH_Uint32, MRH_Uint32), void (*)(MRH_Event*));
+    FunctionSetEventPool = reinterpret_cast<void(*)(MRH_Event* (*)(MRH_Uint32, MRH_Uint32), void (*)(MRH_Event*))>(p_FunctionSetEventPoolLocation);
+    
+    FunctionSetEventPool(AcquireCallback, ReleaseCallback);
+    return true;
+}
+
+//*************************************************************************************
+// Output
+//*************************************************************************************
+
+void PackageService::SetOutput(EventTransport const* p_Transport) noexcept
+{
+    p_OutputTransport = p_Transport;
+    u64_OutputFull = p_Transport != NULL ? p_Transport->GetFullCount() : 0;
+}
+
 //*************************************************************************************
 // Update
 //*************************************************************************************
@@ -164,8 +333,24 @@ bool PackageService::Update() noexcept
     int (*FunctionUpdate)(void);
     FunctionUpdate = reinterpret_cast<int(*)(void)>(p_FunctionUpdateLocation);
     
-    if (FunctionUpdate() < 0)
+    Metrics& c_Metrics = Metrics::Singleton();
+    MRH_Uint64 u64_Start = Metrics::GetTimeNS();
+    
+    c_Profiler.Enter(Watchdog::CALLBACK_UPDATE);
+    Watchdog::Enter(c_Watch, Watchdog::CALLBACK_UPDATE);
+    int i_Result = FunctionUpdate();
+    Watchdog::Leave(c_Watch);
+    c_Profiler.Leave();
+    
+    MRH_Uint64 u64_Duration = Metrics::GetTimeNS() - u64_Start;
+    
+    c_Metrics.Add(Metrics::COUNTER_UPDATE, 1);
+    c_Metrics.Add(Metrics::COUNTER_UPDATE_TIME_NS, u64_Duration);
+    c_Metrics.Record(Metrics::HISTOGRAM_UPDATE_US, u64_Duration / 1000);
+    
+    if (i_Result < 0)
     {
+        c_Metrics.Add(Metrics::COUNTER_UPDATE_FAILED, 1);
         return false;
     }
     
@@ -174,21 +359,188 @@ bool PackageService::Update() noexcept
 
 PackageService::ServiceEventContainer* PackageService::RecieveEvents() noexcept
 {
+    // Backpressure, unsent events count towards the event limit
+    size_t us_Pending = p_ServiceEventContainer->GetEventCount();
+    bool b_OutputFull = false;
+    
+    // Events handed on can still wait in a saturated output
+    if (p_OutputTransport != NULL)
+    {
+        MRH_Uint64 u64_Full = p_OutputTransport->GetFullCount();
+        
+        b_OutputFull = u64_Full != u64_OutputFull;
+        u64_OutputFull = u64_Full;
+    }
+    
+    AdaptEventLimit(us_Pending > 0 || b_OutputFull == true);
+    
+    MRH_Uint32 u32_Max = us_Pending < u32_EventLimit ? u32_EventLimit - static_cast<MRH_Uint32>(us_Pending) : 0;
+    
+    if (u32_Max == 0)
+    {
+        RecordRecieved(0, u32_Max);
+        return p_ServiceEventContainer;
+    }
+    
+    // Batch recieve, one call for up to the event limit
+    if (p_FunctionSendEventBatchLocation != NULL)
+    {
+        MRH_Uint32 (*FunctionSendEventBatch)(MRH_Event**, MRH_Uint32);
+        FunctionSendEventBatch = reinterpret_cast<MRH_Uint32(*)(MRH_Event**, MRH_Uint32)>(p_FunctionSendEventBatchLocation);
+        
+        MRH_Uint32 u32_Recieved = 0;
+        MRH_Uint32 u32_Dropped = 0;
+        MRH_Uint32 u32_Request;
+        MRH_Uint32 u32_Batch;
+        MRH_Uint32 u32_BatchDropped;
+        
+        // One watched call for the whole retrieval
+        c_Profiler.Enter(Watchdog::CALLBACK_SEND_EVENT);
+        Watchdog::Enter(c_Watch, Watchdog::CALLBACK_SEND_EVENT);
+        
+        // Events over quota leave room for others, refill up to the limit
+        do
+        {
+            u32_Request = u32_Max - u32_Recieved;
+            u32_Batch = FunctionSendEventBatch(v_EventBatch.data() + u32_Recieved, u32_Request);
+            u32_BatchDropped = 0;
+            
+            if (u32_Batch > u32_Request)
+            {
+                u32_Batch = u32_Request;
+            }
+            
+            // Keep the order of events within quota
+            if (c_RateLimiter.GetQuotaCount() > 0)
+            {
+                MRH_Uint64 u64_TimeNS = Metrics::GetTimeNS();
+                MRH_Uint32 u32_Kept = u32_Recieved;
+                
+                for (MRH_Uint32 i = u32_Recieved; i < u32_Recieved + u32_Batch; ++i)
+                {
+                    if (CheckQuota(v_EventBatch[i], u64_TimeNS) == true)
+                    {
+                        v_EventBatch[u32_Kept++] = v_EventBatch[i];
+                    }
+                }
+                
+                u32_BatchDropped = u32_Recieved + u32_Batch - u32_Kept;
+                u32_Batch = u32_Kept - u32_Recieved;
+            }
+            
+            u32_Recieved += u32_Batch;
+            u32_Dropped += u32_BatchDropped;
+        }
+        while (u32_BatchDropped > 0 && u32_Batch + u32_BatchDropped == u32_Request &&
+               u32_Recieved < u32_Max && u32_Dropped < u32_Max);
+        
+        Watchdog::Leave(c_Watch);
+        c_Profiler.Leave();
+        
+        p_ServiceEventContainer->AddEvents(v_EventBatch.data(), u32_Recieved);
+        RecordRecieved(u32_Recieved, u32_Max);
+        
+        return p_ServiceEventContainer;
+    }
+    
+    // Single event recieve
     MRH_Event* (*FunctionSendEvent)(void);
     FunctionSendEvent = reinterpret_cast<MRH_Event*(*)(void)>(p_FunctionSendEventLocation);
     
     MRH_Event* p_Event;
     MRH_Uint32 u32_Recieved = 0; // User service spam protection
+    MRH_Uint32 u32_Dropped = 0;
+    MRH_Uint64 u64_TimeNS = c_RateLimiter.GetQuotaCount() > 0 ? Metrics::GetTimeNS() : 0;
     
-    while (u32_Recieved < u32_EventLimit && (p_Event = FunctionSendEvent()) != NULL)
+    // One watched call for the whole retrieval
+    c_Profiler.Enter(Watchdog::CALLBACK_SEND_EVENT);
+    Watchdog::Enter(c_Watch, Watchdog::CALLBACK_SEND_EVENT);
+    
+    // Events over quota leave room for others, but only up to the limit
+    while (u32_Recieved < u32_Max && u32_Dropped < u32_Max && (p_Event = FunctionSendEvent()) != NULL)
     {
+        if (CheckQuota(p_Event, u64_TimeNS) == false)
+        {
+            ++u32_Dropped;
+            continue;
+        }
+        
         p_ServiceEventContainer->AddEvent(p_Event);
         ++u32_Recieved;
     }
     
+    Watchdog::Leave(c_Watch);
+    c_Profiler.Leave();
+    
+    RecordRecieved(u32_Recieved, u32_Max);
+    
     return p_ServiceEventContainer;
 }
 
+void PackageService::RecordRecieved(MRH_Uint32 u32_Recieved, MRH_Uint32 u32_Max) noexcept
+{
+    Metrics& c_Metrics = Metrics::Singleton();
+    
+    c_Metrics.Add(Metrics::COUNTER_EVENTS_RECIEVED, u32_Recieved);
+    c_Metrics.Record(Metrics::HISTOGRAM_EVENTS_PER_CYCLE, u32_Recieved);
+    
+    // Remaining service events wait for the next cycle
+    if (u32_Recieved == u32_Max)
+    {
+        c_Metrics.Add(Metrics::COUNTER_EVENT_LIMIT_REACHED, 1);
+    }
+    
+    b_EventLimitReached = u32_Recieved == u32_Max && u32_Max > 0;
+}
+
+bool PackageService::CheckQuota(MRH_Event*& p_Event, MRH_Uint64 u64_TimeNS) noexcept
+{
+    if (c_RateLimiter.Take(p_Event->u32_Type, u64_TimeNS) == true)
+    {
+        return true;
+    }
+    
+    Metrics::Singleton().Add(Metrics::COUNTER_EVENTS_OVER_QUOTA, 1);
+    EventPool::Singleton().Release(p_Event);
+    
+    return false;
+}
+
+void PackageService::AdaptEventLimit(bool b_Backpressure) noexcept
+{
+    if (u32_MinEventLimit == u32_MaxEventLimit)
+    {
+        return;
+    }
+    
+    // AIMD, halve once a output could not take all events, grow by the
+    // min limit while the service has more events than the output took
+    if (b_Backpressure == true)
+    {
+        // Once per backlog, recieved again after each output wake up
+        if (b_Congested == true)
+        {
+            return;
+        }
+        
+        u32_EventLimit /= 2;
+        
+        if (u32_EventLimit < u32_MinEventLimit)
+        {
+            u32_EventLimit = u32_MinEventLimit;
+        }
+    }
+    else if (b_EventLimitReached == true)
+    {
+        u32_EventLimit = u32_MaxEventLimit - u32_EventLimit > u32_MinEventLimit ? u32_EventLimit + u32_MinEventLimit : u32_MaxEventLimit;
+    }
+    
+    b_EventLimitReached = false;
+    b_Congested = b_Backpressure;
+    
+    Metrics::Singleton().Set(us_MetricsService, Metrics::SERVICE_GAUGE_EVENT_LIMIT, u32_EventLimit);
+}
+
 //*************************************************************************************
 // Exit
 //*************************************************************************************
@@ -198,5 +550,36 @@ void PackageService::Exit() noexcept
     void (*FunctionExit)(void);
     FunctionExit = reinterpret_cast<void(*)(void)>(p_FunctionExitLocation);
     
+    c_Profiler.Enter(Watchdog::CALLBACK_EXIT);
+    Watchdog::Enter(c_Watch, Watchdog::CALLBACK_EXIT);
     FunctionExit();
+    Watchdog::Leave(c_Watch);
+    c_Profiler.Leave();
+    
+    for (size_t i = 0; i < c_RateLimiter.GetQuotaCount(); ++i)
+    {
+        if (c_RateLimiter.GetOverQuota(i) > 0)
+        {
+            MRH_LOG_INFO("Events over quota for event type ", c_RateLimiter.GetType(i), ": ", c_RateLimiter.GetOverQuota(i));
+        }
+    }
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint32 PackageService::GetEventLimit() const noexcept
+{
+    return u32_EventLimit;
+}
+
+MRH_Uint32 PackageService::GetMaxEventLimit() const noexcept
+{
+    return u32_MaxEventLimit;
+}
+
+PackageService::ServiceEventContainer* PackageService::GetRemainingEvents() noexcept
+{
+    return p_ServiceEventContainer;
 }
@@ -18,6 +18,7 @@
 #define PackageService_h
 
 // C / C++
+#include <vector>
 
 // External
 #include <MRH_Event.h>
@@ -25,6 +26,10 @@
 // Project
 #include "./PackageConfiguration.h"
 #include "../Event/EventContainer.h"
+#include "../Event/EventRateLimiter.h"
+#include "../Event/EventTransport.h"
+#include "../Watchdog.h"
+#include "../Profiler.h"
 
 
 class PackageService : public PackageConfiguration
@@ -109,6 +114,15 @@ public:
     // Load
     //*************************************************************************************
     
+    /**
+     *  Start reading the service shared object into the page cache. The read 
+     *  continues in the background, the shared object is not loaded.
+     *
+     *  \return true if the read was started, false if not.
+     */
+    
+    bool Preload() noexcept;
+    
     /**
      *  Load the service shared object for the package.
      */
@@ -124,6 +138,51 @@ public:
      */
     
     void Init();
+    
+    //*************************************************************************************
+    // Notify
+    //*************************************************************************************
+    
+    /**
+     *  Give the application service a callback to signal that events are ready to be 
+     *  recieved. This is optional for application services.
+     *
+     *  \param NotifyCallback The callback for the application service to use.
+     *  \param p_NotifyContext The context to pass to the callback.
+     *
+     *  \return true if the application service accepted the callback, false if not.
+     */
+    
+    bool SetEventNotify(void (*NotifyCallback)(void*), void* p_NotifyContext) noexcept;
+    
+    //*************************************************************************************
+    // Event Pool
+    //*************************************************************************************
+    
+    /**
+     *  Give the application service callbacks to get events from the event pool and 
+     *  return them. This is optional for application services.
+     *
+     *  \param AcquireCallback The callback to get a event with.
+     *  \param ReleaseCallback The callback to return a event with.
+     *
+     *  \return true if the application service accepted the callbacks, false if not.
+     */
+    
+    bool SetEventPool(MRH_Event* (*AcquireCallback)(MRH_Uint32, MRH_Uint32), void (*ReleaseCallback)(MRH_Event*)) noexcept;
+    
+    //*************************************************************************************
+    // Output
+    //*************************************************************************************
+    
+    /**
+     *  Set the transport the recieved events are sent with. A full transport 
+     *  lowers the adaptive event limit.
+     *
+     *  \param p_Transport The transport to watch.
+     */
+    
+    void SetOutput(EventTransport const* p_Transport) noexcept;
 
     //*************************************************************************************
     // Update
@@ -154,9 +213,72 @@ public:
      */
     
     void Exit() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the max amount of events recieved in the next update.
+     *
+     *  \return The current event limit.
+     */
+    
+    MRH_Uint32 GetEventLimit() const noexcept;
+    
+    /**
+     *  Get the highest event limit the adaptive event limit can reach.
+     *
+     *  \return The max event limit.
+     */
+    
+    MRH_Uint32 GetMaxEventLimit() const noexcept;
+    
+    /**
+     *  Get the recieved events which were not sent yet. The application service 
+     *  is not called.
+     *
+     *  \return The app event container.
+     */
+    
+    ServiceEventContainer* GetRemainingEvents() noexcept;
 
 private:
     
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Add recieved events to the metrics.
+     *
+     *  \param u32_Recieved The amount of events recieved.
+     *  \param u32_Max The max amount of events which could be recieved.
+     */
+    
+    void RecordRecieved(MRH_Uint32 u32_Recieved, MRH_Uint32 u32_Max) noexcept;
+    
+    /**
+     *  Check a recieved event against the event type quota. Events over quota 
+     *  are returned to the event pool.
+     *
+     *  \param p_Event The recieved event.
+     *  \param u64_TimeNS The recieve time in nanoseconds.
+     *
+     *  \return true if the event is within the quota, false if it was dropped.
+     */
+    
+    bool CheckQuota(MRH_Event*& p_Event, MRH_Uint64 u64_TimeNS) noexcept;
+    
+    /**
+     *  Adjust the event limit to the rate the output takes events.
+     *
+     *  \param b_Backpressure If the output did not take all recieved events or 
+     *                        was full since the last cycle.
+     */
+    
+    void AdaptEventLimit(bool b_Backpressure) noexcept;
+    
     //*************************************************************************************
     // Data
     //*************************************************************************************
@@ -171,12 +293,38 @@ private:
     void* p_FunctionSendEventLocation;
     void* p_FunctionExitLocation;
     
+    // Optional shared object function locations
+    void* p_FunctionSetEventNotifyLocation;
+    void* p_FunctionSetEventPoolLocation;
+    void* p_FunctionSendEventBatchLocation;
+    
     // Event container
     ServiceEventContainer* p_ServiceEventContainer;
+    std::vector<MRH_Event*> v_EventBatch;
     
-    // Event send limit
+    // Event send limit, adapted within the bounds
     MRH_Uint32 u32_EventLimit;
+    MRH_Uint32 u32_MinEventLimit;
+    MRH_Uint32 u32_MaxEventLimit;
+    bool b_EventLimitReached;
+    bool b_Congested;
+    
+    // Service gauge set
+    size_t us_MetricsService;
     
+    // Output transport and its full count at the last cycle
+    EventTransport const* p_OutputTransport;
+    MRH_Uint64 u64_OutputFull;
+    
+    // Event type quotas
+    EventRateLimiter c_RateLimiter;
+    
+    // Callback time budget
+    Watchdog::Watch c_Watch;
+    
+    // Callback cost
+    Profiler c_Profiler;
+
 protected:
 
 };
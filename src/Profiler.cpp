@@ -0,0 +1,272 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <cstdio>
+#include <cstring>
+
+// External
+
+// Project
+#include "./Profiler.h"
+#include "./Logger.h"
+#include "./Metrics.h"
+#include "./AllocationCounter.h"
+
+// Pre-defined
+#ifndef MRH_USERVICE_PROFILE_FILE_PATH_BASE
+    #define MRH_USERVICE_PROFILE_FILE_PATH_BASE "/var/log/mrh/mrhuservice/prof_mrhuservice_"
+#endif
+
+namespace
+{
+    // Written at the start of each profile file
+    const char* p_Header = "# time_ms,callback,wall_us,cpu_us,minor_faults,major_faults,"
+                           "voluntary_switches,involuntary_switches,allocations,allocated_bytes,frees\n";
+    
+    // Size used for a limit of 0
+    constexpr MRH_Uint32 u32_MinFileSizeKB = 4;
+}
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+Profiler::Profiler() noexcept : i_FD(-1),
+                                i_PreviousFD(-1),
+                                s_FilePath(""),
+                                u64_FileSize(0),
+                                u64_MaxFileSize(0),
+                                e_Callback(Watchdog::CALLBACK_INIT)
+{}
+
+Profiler::~Profiler() noexcept
+{
+    for (int i_File : { i_FD, i_PreviousFD })
+    {
+        if (i_File >= 0)
+        {
+            close(i_File);
+        }
+    }
+}
+
+//*************************************************************************************
+// Open
+//*************************************************************************************
+
+bool Profiler::Open(std::string const& s_PackageName, MRH_Uint32 u32_FileSizeKB) noexcept
+{
+    if (i_FD >= 0)
+    {
+        return true;
+    }
+    
+    std::string s_PreviousFilePath;
+    
+    try
+    {
+        s_FilePath = MRH_USERVICE_PROFILE_FILE_PATH_BASE + s_PackageName + ".log";
+        s_PreviousFilePath = s_FilePath + ".1";
+    }
+    catch (...)
+    {
+        return false;
+    }
+    
+    // Both files are opened before the user change, the service user might 
+    // not be allowed to create files
+    if ((i_FD = open(s_FilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0666)) < 0)
+    {
+        return false;
+    }
+    
+    if ((i_PreviousFD = open(s_PreviousFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0666)) < 0)
+    {
+        close(i_FD);
+        i_FD = -1;
+        
+        return false;
+    }
+    
+    u64_MaxFileSize = static_cast<MRH_Uint64>(u32_FileSizeKB > u32_MinFileSizeKB ? u32_FileSizeKB : u32_MinFileSizeKB) * 1024;
+    u64_FileSize = 0;
+    
+    Write(p_Header, std::strlen(p_Header));
+    
+    return true;
+}
+
+//*************************************************************************************
+// Callback
+//*************************************************************************************
+
+void Profiler::Enter(Watchdog::Callback e_Callback) noexcept
+{
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    this->e_Callback = e_Callback;
+    TakeSample(c_Start);
+}
+
+void Profiler::Leave() noexcept
+{
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    Sample c_End;
+    struct timespec c_Now;
+    
+    TakeSample(c_End);
+    clock_gettime(CLOCK_REALTIME, &c_Now);
+    
+    char p_Line[256];
+    int i_Length = std::snprintf(p_Line, sizeof(p_Line), "%llu,%s,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                                 static_cast<unsigned long long>(c_Now.tv_sec) * 1000 + static_cast<unsigned long long>(c_Now.tv_nsec / 1000000),
+                                 Watchdog::GetCallbackName(e_Callback),
+                                 static_cast<unsigned long long>((c_End.u64_TimeNS - c_Start.u64_TimeNS) / 1000),
+                                 static_cast<unsigned long long>((c_End.u64_CPUTimeNS - c_Start.u64_CPUTimeNS) / 1000),
+                                 static_cast<unsigned long long>(c_End.u64_MinorFaults - c_Start.u64_MinorFaults),
+                                 static_cast<unsigned long long>(c_End.u64_MajorFaults - c_Start.u64_MajorFaults),
+                                 static_cast<unsigned long long>(c_End.u64_VoluntarySwitches - c_Start.u64_VoluntarySwitches),
+                                 static_cast<unsigned long long>(c_End.u64_InvoluntarySwitches - c_Start.u64_InvoluntarySwitches),
+                                 static_cast<unsigned long long>(c_End.u64_Allocations - c_Start.u64_Allocations),
+                                 static_cast<unsigned long long>(c_End.u64_AllocatedBytes - c_Start.u64_AllocatedBytes),
+                                 static_cast<unsigned long long>(c_End.u64_Frees - c_Start.u64_Frees));
+    
+    if (i_Length > 0)
+    {
+        Write(p_Line, static_cast<size_t>(i_Length) < sizeof(p_Line) ? static_cast<size_t>(i_Length) : sizeof(p_Line) - 1);
+    }
+}
+
+//*************************************************************************************
+// Sample
+//*************************************************************************************
+
+void Profiler::TakeSample(Sample& c_Sample) noexcept
+{
+    struct timespec c_CPUTime;
+    struct rusage c_Usage;
+    
+    c_Sample.u64_TimeNS = Metrics::GetTimeNS();
+    
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &c_CPUTime) == 0)
+    {
+        c_Sample.u64_CPUTimeNS = static_cast<MRH_Uint64>(c_CPUTime.tv_sec) * 1000000000 + static_cast<MRH_Uint64>(c_CPUTime.tv_nsec);
+    }
+    else
+    {
+        c_Sample.u64_CPUTimeNS = 0;
+    }
+    
+    if (getrusage(RUSAGE_THREAD, &c_Usage) == 0)
+    {
+        c_Sample.u64_MinorFaults = static_cast<MRH_Uint64>(c_Usage.ru_minflt);
+        c_Sample.u64_MajorFaults = static_cast<MRH_Uint64>(c_Usage.ru_majflt);
+        c_Sample.u64_VoluntarySwitches = static_cast<MRH_Uint64>(c_Usage.ru_nvcsw);
+        c_Sample.u64_InvoluntarySwitches = static_cast<MRH_Uint64>(c_Usage.ru_nivcsw);
+    }
+    else
+    {
+        c_Sample.u64_MinorFaults = 0;
+        c_Sample.u64_MajorFaults = 0;
+        c_Sample.u64_VoluntarySwitches = 0;
+        c_Sample.u64_InvoluntarySwitches = 0;
+    }
+    
+    AllocationCounter::Count c_Count = AllocationCounter::GetThreadCount();
+    
+    c_Sample.u64_Allocations = c_Count.u64_Allocations;
+    c_Sample.u64_AllocatedBytes = c_Count.u64_AllocatedBytes;
+    c_Sample.u64_Frees = c_Count.u64_Frees;
+}
+
+//*************************************************************************************
+// File
+//*************************************************************************************
+
+void Profiler::Write(const char* p_Line, size_t us_Length) noexcept
+{
+    if (u64_FileSize + us_Length > u64_MaxFileSize && u64_FileSize > std::strlen(p_Header))
+    {
+        Roll();
+    }
+    
+    ssize_t ss_Written = write(i_FD, p_Line, us_Length);
+    
+    if (ss_Written > 0)
+    {
+        u64_FileSize += static_cast<MRH_Uint64>(ss_Written);
+    }
+}
+
+void Profiler::Roll() noexcept
+{
+    // The current file keeps its name, the full file is copied to the 
+    // previous one and cleared
+    if (ftruncate(i_PreviousFD, 0) == 0)
+    {
+        char p_Buffer[4096];
+        MRH_Uint64 u64_Offset = 0;
+        ssize_t ss_Read;
+        
+        while ((ss_Read = pread(i_FD, p_Buffer, sizeof(p_Buffer), static_cast<off_t>(u64_Offset))) > 0 &&
+               write(i_PreviousFD, p_Buffer, static_cast<size_t>(ss_Read)) == ss_Read)
+        {
+            u64_Offset += static_cast<MRH_Uint64>(ss_Read);
+        }
+    }
+    
+    // Keep the size limit even if the copy failed
+    if (ftruncate(i_FD, 0) < 0)
+    {
+        return;
+    }
+    
+    u64_FileSize = 0;
+    
+    ssize_t ss_Written = write(i_FD, p_Header, std::strlen(p_Header));
+    
+    if (ss_Written > 0)
+    {
+        u64_FileSize += static_cast<MRH_Uint64>(ss_Written);
+    }
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool Profiler::GetEnabled() const noexcept
+{
+    return i_FD >= 0;
+}
+
+std::string const& Profiler::GetFilePath() const noexcept
+{
+    return s_FilePath;
+}
@@ -0,0 +1,189 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef Profiler_h
+#define Profiler_h
+
+// C / C++
+#include <string>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./Watchdog.h"
+
+
+class Profiler
+{
+public:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. Profiling is disabled until a profile file is opened.
+     */
+    
+    Profiler() noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_Profiler Profiler class source.
+     */
+    
+    Profiler(Profiler const& c_Profiler) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~Profiler() noexcept;
+    
+    //*************************************************************************************
+    // Open
+    //*************************************************************************************
+    
+    /**
+     *  Open the profile files of a package and start profiling. Once the profile 
+     *  file reaches the size limit it is copied to the previous file and cleared.
+     *
+     *  \param s_PackageName The name of the package for the file name.
+     *  \param u32_FileSizeKB The max profile file size in kilobytes.
+     *
+     *  \return true on success, false on failure.
+     */
+    
+    bool Open(std::string const& s_PackageName, MRH_Uint32 u32_FileSizeKB) noexcept;
+    
+    //*************************************************************************************
+    // Callback
+    //*************************************************************************************
+    
+    /**
+     *  Mark the start of a service callback on the calling thread. Calls for the 
+     *  same profiler must not overlap.
+     *
+     *  \param e_Callback The callback called.
+     */
+    
+    void Enter(Watchdog::Callback e_Callback) noexcept;
+    
+    /**
+     *  Mark the end of a service callback and write the profile line. Has to be 
+     *  called on the thread which called Enter().
+     */
+    
+    void Leave() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Check if callbacks are profiled.
+     *
+     *  \return true if profiling, false if not.
+     */
+    
+    bool GetEnabled() const noexcept;
+    
+    /**
+     *  Get the path of the current profile file. The previous file path has ".1" 
+     *  appended.
+     *
+     *  \return The profile file path.
+     */
+    
+    std::string const& GetFilePath() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct Sample
+    {
+        MRH_Uint64 u64_TimeNS;
+        MRH_Uint64 u64_CPUTimeNS;
+        
+        // Thread resource usage
+        MRH_Uint64 u64_MinorFaults;
+        MRH_Uint64 u64_MajorFaults;
+        MRH_Uint64 u64_VoluntarySwitches;
+        MRH_Uint64 u64_InvoluntarySwitches;
+        
+        // Thread allocations
+        MRH_Uint64 u64_Allocations;
+        MRH_Uint64 u64_AllocatedBytes;
+        MRH_Uint64 u64_Frees;
+    };
+    
+    //*************************************************************************************
+    // Sample
+    //*************************************************************************************
+    
+    /**
+     *  Read the counters of the calling thread.
+     *
+     *  \param c_Sample The sample to write to.
+     */
+    
+    static void TakeSample(Sample& c_Sample) noexcept;
+    
+    //*************************************************************************************
+    // File
+    //*************************************************************************************
+    
+    /**
+     *  Write a line to the profile file, rolling the file over if full.
+     *
+     *  \param p_Line The line to write.
+     *  \param us_Length The line length in bytes.
+     */
+    
+    void Write(const char* p_Line, size_t us_Length) noexcept;
+    
+    /**
+     *  Copy the profile file to the previous file and clear it.
+     */
+    
+    void Roll() noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // File
+    int i_FD;
+    int i_PreviousFD;
+    std::string s_FilePath;
+    MRH_Uint64 u64_FileSize;
+    MRH_Uint64 u64_MaxFileSize;
+    
+    // Running callback
+    Watchdog::Callback e_Callback;
+    Sample c_Start;
+
+protected:
+
+};
+
+#endif /* Profiler_h */
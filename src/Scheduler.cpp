@@ -0,0 +1,470 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+// External
+
+// Project
+#include "./Scheduler.h"
+#include "./Logger.h"
+#include "./Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Crash signal handler stack, usable on stack overflow
+    constexpr size_t us_SignalStackSize = 65536;
+    
+    // Signal stack allocated for this thread, NULL if none
+    thread_local void* p_SignalStack = NULL;
+    
+    // Signal mask before blocking the control signals
+    sigset_t c_PreviousSignals;
+    
+    /**
+     *  Get the control signals handled by the scheduler.
+     *
+     *  \return The signal set.
+     */
+    
+    sigset_t GetControlSignals() noexcept
+    {
+        sigset_t c_Set;
+        
+        // @NOTE: SIGUSR2 and SIGABRT are sent to single threads by the watchdog 
+        //        and have to stay unblocked
+        sigemptyset(&c_Set);
+        sigaddset(&c_Set, SIGTERM);
+        sigaddset(&c_Set, SIGINT);
+        sigaddset(&c_Set, SIGHUP);
+        
+        return c_Set;
+    }
+    
+    /**
+     *  Restore the signal mask in a forked child. Processes started by 
+     *  services should not inherit the blocked control signals.
+     */
+    
+    void RestoreSignals() noexcept
+    {
+        pthread_sigmask(SIG_SETMASK, &c_PreviousSignals, NULL);
+    }
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+Scheduler::Scheduler() : i_EpollFD(-1),
+                         i_TimerFD(-1),
+                         i_EventFD(-1),
+                         i_OutputFD(-1),
+                         i_SignalFD(-1),
+                         i_Signal(-1),
+                         u64_ArmedNS(0),
+                         u32_Pending(0)
+{
+    for (size_t i = 0; i < WAKE_TYPE_COUNT; ++i)
+    {
+        TimerWheel::InitEntry(p_Timer[i], NULL);
+    }
+    
+    sigset_t c_Signals = GetControlSignals();
+    
+    if ((i_EpollFD = epoll_create1(EPOLL_CLOEXEC)) < 0 ||
+        (i_TimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) < 0 ||
+        (i_EventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0 ||
+        (i_SignalFD = signalfd(-1, &c_Signals, SFD_NONBLOCK | SFD_CLOEXEC)) < 0)
+    {
+        std::string s_Error = std::string(std::strerror(errno)) + " (" + std::to_string(errno) + ")";
+        Close();
+        
+        throw Exception("Failed to create scheduler file descriptors: " + s_Error + "!");
+    }
+    
+    struct epoll_event c_Event;
+    std::memset(&c_Event, 0, sizeof(c_Event));
+    
+    c_Event.events = EPOLLIN;
+    c_Event.data.u32 = WAKE_UPDATE;
+    
+    if (epoll_ctl(i_EpollFD, EPOLL_CTL_ADD, i_TimerFD, &c_Event) < 0)
+    {
+        Close();
+        throw Exception("Failed to add update timer to scheduler!");
+    }
+    
+    c_Event.data.u32 = WAKE_EVENTS;
+    
+    if (epoll_ctl(i_EpollFD, EPOLL_CTL_ADD, i_EventFD, &c_Event) < 0)
+    {
+        Close();
+        throw Exception("Failed to add event notification to scheduler!");
+    }
+    
+    c_Event.data.u32 = WAKE_SIGNAL;
+    
+    if (epoll_ctl(i_EpollFD, EPOLL_CTL_ADD, i_SignalFD, &c_Event) < 0)
+    {
+        Close();
+        throw Exception("Failed to add signal notification to scheduler!");
+    }
+}
+
+Scheduler::~Scheduler() noexcept
+{
+    Close();
+}
+
+//*************************************************************************************
+// Close
+//*************************************************************************************
+
+void Scheduler::Close() noexcept
+{
+    if (i_SignalFD >= 0)
+    {
+        close(i_SignalFD);
+        i_SignalFD = -1;
+    }
+    
+    if (i_EventFD >= 0)
+    {
+        close(i_EventFD);
+        i_EventFD = -1;
+    }
+    
+    if (i_TimerFD >= 0)
+    {
+        close(i_TimerFD);
+        i_TimerFD = -1;
+    }
+    
+    if (i_EpollFD >= 0)
+    {
+        close(i_EpollFD);
+        i_EpollFD = -1;
+    }
+}
+
+//*************************************************************************************
+// Signals
+//*************************************************************************************
+
+void Scheduler::BlockSignals() noexcept
+{
+    sigset_t c_Signals = GetControlSignals();
+    
+    // Only readable through the signal file descriptor afterwards
+    if (pthread_sigmask(SIG_BLOCK, &c_Signals, &c_PreviousSignals) != 0)
+    {
+        MRH_LOG_ERROR("Failed to block control signals!");
+    }
+    else if (pthread_atfork(NULL, NULL, RestoreSignals) != 0)
+    {
+        MRH_LOG_WARNING("Failed to restore signals for forked processes!");
+    }
+}
+
+bool Scheduler::SetSignalStack() noexcept
+{
+    stack_t c_SignalStack;
+    
+    if (sigaltstack(NULL, &c_SignalStack) == 0 && (c_SignalStack.ss_flags & SS_DISABLE) == 0)
+    {
+        return true;
+    }
+    
+    if ((c_SignalStack.ss_sp = std::malloc(us_SignalStackSize)) == NULL)
+    {
+        return false;
+    }
+    
+    c_SignalStack.ss_size = us_SignalStackSize;
+    c_SignalStack.ss_flags = 0;
+    
+    if (sigaltstack(&c_SignalStack, NULL) < 0)
+    {
+        std::free(c_SignalStack.ss_sp);
+        return false;
+    }
+    
+    p_SignalStack = c_SignalStack.ss_sp;
+    
+    return true;
+}
+
+void Scheduler::RemoveSignalStack() noexcept
+{
+    if (p_SignalStack == NULL)
+    {
+        return;
+    }
+    
+    stack_t c_SignalStack;
+    
+    std::memset(&c_SignalStack, 0, sizeof(c_SignalStack));
+    c_SignalStack.ss_flags = SS_DISABLE;
+    
+    // Still in use if disabling failed
+    if (sigaltstack(&c_SignalStack, NULL) == 0)
+    {
+        std::free(p_SignalStack);
+        p_SignalStack = NULL;
+    }
+}
+
+//*************************************************************************************
+// Schedule
+//*************************************************************************************
+
+void Scheduler::Schedule(WakeType e_Type, MRH_Uint64 u64_DeadlineNS) noexcept
+{
+    if (e_Type != WAKE_UPDATE && e_Type != WAKE_FLUSH)
+    {
+        return;
+    }
+    
+    c_TimerWheel.Schedule(p_Timer[e_Type], u64_DeadlineNS);
+    ArmTimer();
+}
+
+void Scheduler::Cancel(WakeType e_Type) noexcept
+{
+    if (e_Type < WAKE_TYPE_COUNT)
+    {
+        c_TimerWheel.Cancel(p_Timer[e_Type]);
+        u32_Pending &= ~(1U << e_Type);
+        
+        ArmTimer();
+    }
+}
+
+//*************************************************************************************
+// Timer
+//*************************************************************************************
+
+void Scheduler::ArmTimer() noexcept
+{
+    MRH_Uint64 u64_DeadlineNS;
+    
+    if (c_TimerWheel.GetNextDeadline(u64_DeadlineNS) == false)
+    {
+        u64_DeadlineNS = 0;
+    }
+    
+    // Unchanged deadlines need no system call
+    if (u64_DeadlineNS == u64_ArmedNS)
+    {
+        return;
+    }
+    
+    struct itimerspec c_Timer;
+    std::memset(&c_Timer, 0, sizeof(c_Timer));
+    
+    // @NOTE: A zero value disarms the timer, an expired deadline fires at once
+    c_Timer.it_value.tv_sec = static_cast<time_t>(u64_DeadlineNS / 1000000000);
+    c_Timer.it_value.tv_nsec = static_cast<long>(u64_DeadlineNS % 1000000000);
+    
+    if (timerfd_settime(i_TimerFD, TFD_TIMER_ABSTIME, &c_Timer, NULL) < 0)
+    {
+        MRH_LOG_ERROR("Failed to set scheduler timer: ", std::strerror(errno));
+        return;
+    }
+    
+    u64_ArmedNS = u64_DeadlineNS;
+}
+
+//*************************************************************************************
+// Notify
+//*************************************************************************************
+
+void Scheduler::NotifyEvents() noexcept
+{
+    uint64_t u64_Value = 1;
+    
+    // Non-blocking, a full counter means a wake up is pending anyway
+    if (write(i_EventFD, &u64_Value, sizeof(u64_Value)) < 0)
+    {}
+}
+
+void Scheduler::NotifyEvents(void* p_Scheduler) noexcept
+{
+    if (p_Scheduler != NULL)
+    {
+        static_cast<Scheduler*>(p_Scheduler)->NotifyEvents();
+    }
+}
+
+//*************************************************************************************
+// Output
+//*************************************************************************************
+
+void Scheduler::WatchOutput(int i_FD, bool b_Doorbell) noexcept
+{
+    if (i_FD == i_OutputFD)
+    {
+        return;
+    }
+    
+    if (i_OutputFD >= 0)
+    {
+        epoll_ctl(i_EpollFD, EPOLL_CTL_DEL, i_OutputFD, NULL);
+        i_OutputFD = -1;
+    }
+    
+    if (i_FD < 0)
+    {
+        return;
+    }
+    
+    struct epoll_event c_Event;
+    std::memset(&c_Event, 0, sizeof(c_Event));
+    
+    c_Event.events = b_Doorbell == true ? EPOLLIN : EPOLLOUT;
+    c_Event.data.u32 = WAKE_OUTPUT;
+    
+    if (epoll_ctl(i_EpollFD, EPOLL_CTL_ADD, i_FD, &c_Event) < 0)
+    {
+        MRH_LOG_WARNING("Failed to watch event output: ", std::strerror(errno));
+        return;
+    }
+    
+    i_OutputFD = i_FD;
+}
+
+//*************************************************************************************
+// Wait
+//*************************************************************************************
+
+Scheduler::WakeType Scheduler::Wait() noexcept
+{
+    // Returned after the earlier wake up
+    if (u32_Pending != 0)
+    {
+        return TakePending();
+    }
+    
+    struct epoll_event p_Event[WAKE_TYPE_COUNT];
+    int i_Count = epoll_wait(i_EpollFD, p_Event, WAKE_TYPE_COUNT, -1);
+    
+    // Interrupted by a signal, let the caller check
+    if (i_Count <= 0)
+    {
+        return WAKE_INTERRUPT;
+    }
+    
+    struct signalfd_siginfo c_Info;
+    uint64_t u64_Value;
+    bool b_Output = false;
+    bool b_Signal = false;
+    
+    for (int i = 0; i < i_Count; ++i)
+    {
+        switch (p_Event[i].data.u32)
+        {
+            case WAKE_UPDATE:
+                if (read(i_TimerFD, &u64_Value, sizeof(u64_Value)) > 0)
+                {
+                    // Fired, rearmed for the next timer below
+                    u64_ArmedNS = 0;
+                    
+                    for (TimerWheel::Entry* p_Entry = c_TimerWheel.Expire(Metrics::GetTimeNS()); p_Entry != NULL; p_Entry = p_Entry->p_Next)
+                    {
+                        u32_Pending |= 1U << static_cast<MRH_Uint32>(p_Entry - p_Timer);
+                    }
+                    
+                    ArmTimer();
+                }
+                break;
+            
+            case WAKE_EVENTS:
+                if (read(i_EventFD, &u64_Value, sizeof(u64_Value)) > 0)
+                {
+                    u32_Pending |= 1U << WAKE_EVENTS;
+                }
+                break;
+            
+            case WAKE_OUTPUT:
+                // Level triggered, stays ready until watching stops
+                b_Output = true;
+                break;
+            
+            case WAKE_SIGNAL:
+                if (read(i_SignalFD, &c_Info, sizeof(c_Info)) == sizeof(c_Info))
+                {
+                    i_Signal = static_cast<int>(c_Info.ssi_signo);
+                    b_Signal = true;
+                }
+                break;
+            
+            default:
+                break;
+        }
+    }
+    
+    // Updates recieve events as well
+    if ((u32_Pending & (1U << WAKE_UPDATE)) != 0)
+    {
+        u32_Pending &= ~(1U << WAKE_EVENTS);
+    }
+    
+    // Signals go first, everything else stays pending
+    if (b_Signal == true)
+    {
+        return WAKE_SIGNAL;
+    }
+    
+    if (u32_Pending == 0)
+    {
+        return b_Output == true ? WAKE_OUTPUT : WAKE_INTERRUPT;
+    }
+    
+    return TakePending();
+}
+
+Scheduler::WakeType Scheduler::TakePending() noexcept
+{
+    // Lowest wake type first
+    WakeType e_Type = static_cast<WakeType>(__builtin_ctz(u32_Pending));
+    u32_Pending &= ~(1U << e_Type);
+    
+    return e_Type;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+int Scheduler::GetSignal() const noexcept
+{
+    return i_Signal;
+}
@@ -0,0 +1,244 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef Scheduler_h
+#define Scheduler_h
+
+// C / C++
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./TimerWheel.h"
+#include "./Exception.h"
+
+
+class Scheduler
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        WAKE_UPDATE = 0,
+        WAKE_EVENTS = 1,
+        WAKE_OUTPUT = 2,
+        WAKE_FLUSH = 3,
+        WAKE_SIGNAL = 4,
+        WAKE_INTERRUPT = 5,
+        
+        WAKE_TYPE_MAX = WAKE_INTERRUPT,
+        
+        WAKE_TYPE_COUNT = WAKE_TYPE_MAX + 1
+    
+    }WakeType;
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     */
+    
+    Scheduler();
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_Scheduler Scheduler class source.
+     */
+    
+    Scheduler(Scheduler const& c_Scheduler) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~Scheduler() noexcept;
+    
+    //*************************************************************************************
+    // Signals
+    //*************************************************************************************
+    
+    /**
+     *  Block the control signals recieved by the scheduler. Has to be called before 
+     *  any thread is created so that all threads inherit the signal mask. Forked 
+     *  child processes get the previous signal mask back. Has to be called once.
+     */
+    
+    static void BlockSignals() noexcept;
+    
+    /**
+     *  Give the calling thread its own alternate signal stack, used by the crash 
+     *  signal handlers on stack overflow. Threads which already have one keep it.
+     *
+     *  \return true if the thread has a signal stack, false if not.
+     */
+    
+    static bool SetSignalStack() noexcept;
+    
+    /**
+     *  Remove the signal stack set by SetSignalStack for the calling thread. Has 
+     *  to be called before the thread exits.
+     */
+    
+    static void RemoveSignalStack() noexcept;
+    
+    //*************************************************************************************
+    // Schedule
+    //*************************************************************************************
+    
+    /**
+     *  Schedule a timer for a absolute deadline. A scheduled timer is moved to 
+     *  the new deadline. Only the earliest timer arms the wake up.
+     *
+     *  \param e_Type The wake type of the timer, WAKE_UPDATE or WAKE_FLUSH.
+     *  \param u64_DeadlineNS The monotonic clock deadline in nanoseconds.
+     */
+    
+    void Schedule(WakeType e_Type, MRH_Uint64 u64_DeadlineNS) noexcept;
+    
+    /**
+     *  Cancel a scheduled timer.
+     *
+     *  \param e_Type The wake type of the timer.
+     */
+    
+    void Cancel(WakeType e_Type) noexcept;
+    
+    //*************************************************************************************
+    // Notify
+    //*************************************************************************************
+    
+    /**
+     *  Notify the scheduler that events are ready to be recieved. This function
+     *  is thread safe and async signal safe.
+     */
+    
+    void NotifyEvents() noexcept;
+    
+    /**
+     *  Notify the scheduler that events are ready to be recieved. This function
+     *  is meant to be given to the application service as a callback.
+     *
+     *  \param p_Scheduler The scheduler to notify.
+     */
+    
+    static void NotifyEvents(void* p_Scheduler) noexcept;
+    
+    //*************************************************************************************
+    // Output
+    //*************************************************************************************
+    
+    /**
+     *  Wake when a output file descriptor becomes writable. Only one output can be 
+     *  watched at a time.
+     *
+     *  \param i_FD The output file descriptor, -1 to stop watching.
+     *  \param b_Doorbell If the output signals space by becoming readable instead.
+     */
+    
+    void WatchOutput(int i_FD, bool b_Doorbell = false) noexcept;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Wait until a timer is due, events are ready to be recieved, the watched 
+     *  output became writable or a control signal was recieved. Timers due at the 
+     *  same time are returned by the following calls without waiting.
+     *
+     *  \return The reason for waking up.
+     */
+    
+    WakeType Wait() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the last control signal recieved.
+     *
+     *  \return The signal number, -1 if none was recieved.
+     */
+    
+    int GetSignal() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Close
+    //*************************************************************************************
+    
+    /**
+     *  Close all scheduler file descriptors.
+     */
+    
+    void Close() noexcept;
+    
+    //*************************************************************************************
+    // Timer
+    //*************************************************************************************
+    
+    /**
+     *  Arm the timer file descriptor for the earliest timer deadline.
+     */
+    
+    void ArmTimer() noexcept;
+    
+    //*************************************************************************************
+    // Wait
+    //*************************************************************************************
+    
+    /**
+     *  Take the next pending wake type.
+     *
+     *  \return The wake type.
+     */
+    
+    WakeType TakePending() noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    int i_EpollFD;
+    int i_TimerFD;
+    int i_EventFD;
+    int i_OutputFD;
+    int i_SignalFD;
+    
+    // Last control signal read
+    int i_Signal;
+    
+    // Timers, the timer file descriptor is armed for the earliest
+    TimerWheel c_TimerWheel;
+    TimerWheel::Entry p_Timer[WAKE_TYPE_COUNT];
+    MRH_Uint64 u64_ArmedNS; // 0 if disarmed
+    MRH_Uint32 u32_Pending; // Wake type bits not returned yet
+
+protected:
+
+};
+
+#endif /* Scheduler_h */
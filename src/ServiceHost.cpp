@@ -0,0 +1,704 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C / C++
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+// External
+
+// Project
+#include "./ServiceHost.h"
+#include "./Event/EventPool.h"
+#include "./Logger.h"
+#include "./Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Wait while every service is updating, a finished update wakes earlier
+    constexpr MRH_Uint64 u64_IdleWaitNS = 60000000000ULL;
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+ServiceHost::ServiceHost(std::vector<const char*> const& v_PackagePath,
+                         const char* p_EventLimit,
+                         Scheduler* p_Scheduler) : us_NextService(0),
+                                                   p_Scheduler(p_Scheduler),
+                                                   u64_Wake(0),
+                                                   b_Run(false)
+{
+    if (v_PackagePath.size() == 0 || p_Scheduler == NULL)
+    {
+        throw Exception("Invalid service host setup recieved!");
+    }
+    
+    try
+    {
+        for (auto& Path : v_PackagePath)
+        {
+            HostedService* p_Hosted = new HostedService();
+            
+            p_Hosted->p_Service = NULL;
+            p_Hosted->s_PackagePath = Path;
+            p_Hosted->b_Initialized = false;
+            p_Hosted->u64_NextUpdateNS = 0;
+            p_Hosted->us_Worker = 0;
+            p_Hosted->b_Failed = false;
+            p_Hosted->b_Events = false;
+            p_Hosted->p_Host = this;
+            
+            TimerWheel::InitEntry(p_Hosted->c_Timer, p_Hosted);
+            v_Service.emplace_back(p_Hosted);
+            p_Hosted->p_Service = new PackageService(Path, p_EventLimit);
+        }
+    }
+    catch (Exception&)
+    {
+        Stop();
+        throw;
+    }
+    catch (std::exception& e)
+    {
+        Stop();
+        throw Exception("Failed to create hosted services: " + std::string(e.what()));
+    }
+    
+    // @NOTE: The host process switches user once, services can't differ
+    PackageService* p_First = v_Service[0]->p_Service;
+    
+    for (auto& Hosted : v_Service)
+    {
+        if (Hosted->p_Service->GetUserID() != p_First->GetUserID() ||
+            Hosted->p_Service->GetGroupID() != p_First->GetGroupID())
+        {
+            std::string s_Path(Hosted->s_PackagePath);
+            Stop();
+            
+            throw Exception("Hosted package " + s_Path + " uses a different user or group id!");
+        }
+    }
+}
+
+ServiceHost::~ServiceHost() noexcept
+{
+    Stop();
+    
+    for (auto& Hosted : v_Service)
+    {
+        if (Hosted->p_Service != NULL)
+        {
+            delete Hosted->p_Service;
+        }
+        
+        delete Hosted;
+    }
+}
+
+//*************************************************************************************
+// Init
+//*************************************************************************************
+
+void ServiceHost::Preload() noexcept
+{
+    for (auto& Hosted : v_Service)
+    {
+        if (Hosted->p_Service->GetPreload() == true)
+        {
+            Hosted->p_Service->Preload();
+        }
+    }
+}
+
+void ServiceHost::Init(size_t us_WorkerCount)
+{
+    // @NOTE: The loader is locked while loading, only the init functions 
+    //        run at the same time
+    for (auto& Hosted : v_Service)
+    {
+        PackageService* p_Service = Hosted->p_Service;
+        MRH_Uint64 u64_LoadNS = Metrics::GetTimeNS();
+        
+        p_Service->LoadSharedObject();
+        
+        if (p_Service->SetEventNotify(ServiceHost::NotifyEvents, Hosted) == true)
+        {
+            MRH_LOG_INFO(Hosted->s_PackagePath, " supports event notification.");
+        }
+        
+        if (EventPool::Singleton().GetEnabled() == true)
+        {
+            p_Service->SetEventPool(EventPool::AcquireEvent, EventPool::ReleaseEvent);
+        }
+        
+        MRH_LOG_INFO(Hosted->s_PackagePath, " loaded in ", (Metrics::GetTimeNS() - u64_LoadNS) / 1000, " us.");
+        (void)u64_LoadNS; // Unused without info logs
+    }
+    
+    size_t us_InitCount = std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)), v_Service.size());
+    std::vector<std::thread> v_InitThread;
+    std::atomic<size_t> us_NextInit(0);
+    std::vector<std::string> v_InitError(v_Service.size());
+    
+    auto InitServices = [&]() -> void
+    {
+        size_t us_Index;
+        
+        while ((us_Index = us_NextInit.fetch_add(1, std::memory_order_relaxed)) < v_Service.size())
+        {
+            HostedService* p_Hosted = v_Service[us_Index];
+            MRH_Uint64 u64_InitNS = Metrics::GetTimeNS();
+            
+            try
+            {
+                p_Hosted->p_Service->Init();
+                p_Hosted->b_Initialized = true;
+                
+                MRH_LOG_INFO(p_Hosted->s_PackagePath, " initialized in ", (Metrics::GetTimeNS() - u64_InitNS) / 1000, " us.");
+                (void)u64_InitNS; // Unused without info logs
+            }
+            catch (std::exception& e)
+            {
+                v_InitError[us_Index] = e.what();
+            }
+        }
+    };
+    
+    // The calling thread initializes as well, missing threads only slow 
+    // down the init
+    try
+    {
+        for (size_t i = 1; i < us_InitCount; ++i)
+        {
+            // Services can crash in init, keep the crash handler usable
+            v_InitThread.emplace_back([&]() -> void
+            {
+                if (Scheduler::SetSignalStack() == false)
+                {
+                    MRH_LOG_WARNING("Failed to set init thread signal stack: ", std::strerror(errno));
+                }
+                
+                InitServices();
+                Scheduler::RemoveSignalStack();
+            });
+        }
+    }
+    catch (std::exception& e)
+    {
+        MRH_LOG_WARNING("Failed to start service init thread: ", e.what());
+    }
+    
+    InitServices();
+    
+    for (auto& Thread : v_InitThread)
+    {
+        Thread.join();
+    }
+    
+    for (size_t i = 0; i < v_Service.size(); ++i)
+    {
+        if (v_Service[i]->b_Initialized == false)
+        {
+            throw Exception(v_Service[i]->s_PackagePath + ": " + v_InitError[i]);
+        }
+    }
+    
+    // More workers than services never run
+    if (us_WorkerCount == 0)
+    {
+        us_WorkerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    
+    us_WorkerCount = std::min(us_WorkerCount, v_Service.size());
+    
+    // Spread the services, workers keep the services they updated last
+    MRH_Uint64 u64_Now = Metrics::GetTimeNS();
+    
+    for (size_t i = 0; i < v_Service.size(); ++i)
+    {
+        v_Service[i]->us_Worker = i % us_WorkerCount;
+        v_Service[i]->u64_NextUpdateNS = u64_Now;
+        
+        c_TimerWheel.Schedule(v_Service[i]->c_Timer, u64_Now);
+    }
+    
+    cpu_set_t c_CPUSet;
+    std::vector<int> v_CPU;
+    
+    if (sched_getaffinity(0, sizeof(c_CPUSet), &c_CPUSet) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE; ++i)
+        {
+            if (CPU_ISSET(i, &c_CPUSet))
+            {
+                v_CPU.emplace_back(i);
+            }
+        }
+    }
+    
+    try
+    {
+        b_Run = true;
+        v_Worker.reserve(us_WorkerCount);
+        
+        for (size_t i = 0; i < us_WorkerCount; ++i)
+        {
+            Worker* p_Worker = new Worker();
+            
+            p_Worker->b_Busy = false;
+            p_Worker->us_Index = i;
+            p_Worker->p_Host = this;
+            
+            // Queues hold every service at most once, adding never allocates
+            p_Worker->v_Queue.reserve(v_Service.size());
+            
+            v_Worker.emplace_back(p_Worker);
+            p_Worker->c_Thread = std::thread(ServiceHost::Run, p_Worker);
+            
+            // Sharing cores would only move the queues around
+            if (us_WorkerCount <= v_CPU.size())
+            {
+                cpu_set_t c_WorkerSet;
+                
+                CPU_ZERO(&c_WorkerSet);
+                CPU_SET(v_CPU[i], &c_WorkerSet);
+                
+                if (pthread_setaffinity_np(p_Worker->c_Thread.native_handle(), sizeof(c_WorkerSet), &c_WorkerSet) != 0)
+                {
+                    MRH_LOG_WARNING("Failed to pin service worker ", i, " to core ", v_CPU[i], "!");
+                }
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        Stop();
+        throw Exception("Failed to start service workers: " + std::string(e.what()));
+    }
+}
+
+void ServiceHost::SetOutput(EventTransport const* p_Transport) noexcept
+{
+    for (auto& Hosted : v_Service)
+    {
+        Hosted->p_Service->SetOutput(p_Transport);
+    }
+}
+
+//*************************************************************************************
+// Notify
+//*************************************************************************************
+
+void ServiceHost::NotifyEvents(void* p_HostedService) noexcept
+{
+    if (p_HostedService == NULL)
+    {
+        return;
+    }
+    
+    HostedService* p_Hosted = static_cast<HostedService*>(p_HostedService);
+    
+    p_Hosted->b_Events.store(true, std::memory_order_release);
+    p_Hosted->p_Host->p_Scheduler->NotifyEvents();
+}
+
+//*************************************************************************************
+// Run
+//*************************************************************************************
+
+void ServiceHost::Run(Worker* p_Worker) noexcept
+{
+    ServiceHost* p_Instance = p_Worker->p_Host;
+    HostedService* p_Hosted;
+    MRH_Uint64 u64_Wake;
+    
+    // Signal stacks are per thread, the crash handler needs one on stack overflow
+    if (Scheduler::SetSignalStack() == false)
+    {
+        MRH_LOG_WARNING("Failed to set worker ", p_Worker->us_Index, " signal stack: ", std::strerror(errno));
+    }
+    
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> c_Guard(p_Instance->c_Mutex);
+            
+            if (p_Instance->b_Run == false)
+            {
+                break;
+            }
+            
+            u64_Wake = p_Instance->u64_Wake;
+        }
+        
+        if ((p_Hosted = p_Instance->Take(p_Worker)) != NULL)
+        {
+            p_Instance->Update(p_Worker, p_Hosted);
+            continue;
+        }
+        
+        // Work added after reading the wake value is never missed
+        std::unique_lock<std::mutex> c_Lock(p_Instance->c_Mutex);
+        
+        p_Instance->c_Condition.wait(c_Lock, [p_Instance, u64_Wake]()
+        {
+            return p_Instance->u64_Wake != u64_Wake || p_Instance->b_Run == false;
+        });
+    }
+    
+    Scheduler::RemoveSignalStack();
+}
+
+ServiceHost::HostedService* ServiceHost::Take(Worker* p_Worker) noexcept
+{
+    HostedService* p_Hosted = NULL;
+    bool b_Wake = false;
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(p_Worker->c_Mutex);
+        
+        if (p_Worker->v_Queue.size() > 0)
+        {
+            std::pop_heap(p_Worker->v_Queue.begin(), p_Worker->v_Queue.end(), CompareDeadline);
+            p_Hosted = p_Worker->v_Queue.back();
+            p_Worker->v_Queue.pop_back();
+        }
+    }
+    
+    // Steal the earliest deadline waiting behind a running update
+    if (p_Hosted == NULL)
+    {
+        Worker* p_Victim = NULL;
+        MRH_Uint64 u64_Deadline = 0;
+        
+        for (auto& Victim : v_Worker)
+        {
+            if (Victim == p_Worker)
+            {
+                continue;
+            }
+            
+            std::lock_guard<std::mutex> c_Guard(Victim->c_Mutex);
+            
+            if (Victim->b_Busy == true && Victim->v_Queue.size() > 0 &&
+                (p_Victim == NULL || Victim->v_Queue.front()->u64_NextUpdateNS < u64_Deadline))
+            {
+                p_Victim = Victim;
+                u64_Deadline = Victim->v_Queue.front()->u64_NextUpdateNS;
+            }
+        }
+        
+        if (p_Victim != NULL)
+        {
+            std::lock_guard<std::mutex> c_Guard(p_Victim->c_Mutex);
+            
+            // Taken by the owner or another thief meanwhile
+            if (p_Victim->b_Busy == true && p_Victim->v_Queue.size() > 0)
+            {
+                std::pop_heap(p_Victim->v_Queue.begin(), p_Victim->v_Queue.end(), CompareDeadline);
+                p_Hosted = p_Victim->v_Queue.back();
+                p_Victim->v_Queue.pop_back();
+                
+                Metrics::Singleton().Add(Metrics::COUNTER_UPDATE_STOLEN, 1);
+            }
+        }
+    }
+    
+    if (p_Hosted == NULL)
+    {
+        return NULL;
+    }
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(p_Worker->c_Mutex);
+        
+        p_Worker->b_Busy = true;
+        b_Wake = p_Worker->v_Queue.size() > 0 ? true : false;
+    }
+    
+    // Services left in the queue can now be stolen by idle workers
+    if (b_Wake == true)
+    {
+        WakeWorkers();
+    }
+    
+    return p_Hosted;
+}
+
+void ServiceHost::Update(Worker* p_Worker, HostedService* p_Hosted) noexcept
+{
+    MRH_Uint64 u64_Start = Metrics::GetTimeNS();
+    bool b_Result;
+    
+    // @NOTE: The deadline is only written by the worker owning the service
+    if (u64_Start > p_Hosted->u64_NextUpdateNS)
+    {
+        Metrics::Singleton().Record(Metrics::HISTOGRAM_UPDATE_DELAY_US, (u64_Start - p_Hosted->u64_NextUpdateNS) / 1000);
+    }
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(p_Hosted->c_Mutex);
+        
+        // Recieve right away, the main thread only has to send
+        if ((b_Result = p_Hosted->p_Service->Update()) == true)
+        {
+            p_Hosted->p_Service->RecieveEvents();
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        
+        p_Hosted->b_Failed = b_Result == false ? true : false;
+        p_Hosted->us_Worker = p_Worker->us_Index;
+        
+        // Next update follows the last deadline, update time does not drift
+        if (b_Result == true)
+        {
+            p_Hosted->u64_NextUpdateNS = TimerWheel::GetPeriodDeadline(p_Hosted->u64_NextUpdateNS,
+                                                                       static_cast<MRH_Uint64>(p_Hosted->p_Service->GetUpdateTimerS()) * 1000000000,
+                                                                       Metrics::GetTimeNS());
+            c_TimerWheel.Schedule(p_Hosted->c_Timer, p_Hosted->u64_NextUpdateNS);
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(p_Worker->c_Mutex);
+        p_Worker->b_Busy = false;
+    }
+    
+    if (b_Result == false)
+    {
+        MRH_LOG_ERROR(p_Hosted->s_PackagePath, " failed to update, service stopped!");
+    }
+    
+    // Send the recieved events, this also reschedules
+    NotifyEvents(p_Hosted);
+}
+
+void ServiceHost::WakeWorkers() noexcept
+{
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        ++u64_Wake;
+    }
+    
+    c_Condition.notify_all();
+}
+
+bool ServiceHost::CompareDeadline(HostedService const* p_A, HostedService const* p_B) noexcept
+{
+    return p_A->u64_NextUpdateNS > p_B->u64_NextUpdateNS;
+}
+
+//*************************************************************************************
+// Update
+//*************************************************************************************
+
+void ServiceHost::DispatchUpdates() noexcept
+{
+    bool b_Dispatched = false;
+    
+    if (v_Worker.size() == 0)
+    {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        
+        // Only due services expire, the others are not touched
+        TimerWheel::Entry* p_Entry = c_TimerWheel.Expire(Metrics::GetTimeNS());
+        
+        for (; p_Entry != NULL; p_Entry = p_Entry->p_Next)
+        {
+            HostedService* p_Hosted = static_cast<HostedService*>(p_Entry->p_Data);
+            Worker* p_Worker = v_Worker[p_Hosted->us_Worker];
+            
+            {
+                std::lock_guard<std::mutex> c_Guard(p_Worker->c_Mutex);
+                
+                p_Worker->v_Queue.emplace_back(p_Hosted);
+                std::push_heap(p_Worker->v_Queue.begin(), p_Worker->v_Queue.end(), CompareDeadline);
+            }
+            
+            b_Dispatched = true;
+        }
+        
+        if (b_Dispatched == true)
+        {
+            ++u64_Wake;
+        }
+    }
+    
+    if (b_Dispatched == true)
+    {
+        c_Condition.notify_all();
+    }
+}
+
+//*************************************************************************************
+// Send
+//*************************************************************************************
+
+void ServiceHost::SendEvents(EventHandler* p_EventHandler) noexcept
+{
+    size_t us_Count = v_Service.size();
+    
+    // Rotate the start, a full output should not always favour the same service
+    for (size_t i = 0; i < us_Count; ++i)
+    {
+        HostedService* p_Hosted = v_Service[(us_NextService + i) % us_Count];
+        
+        if (p_Hosted->b_Events.exchange(false, std::memory_order_acquire) == false)
+        {
+            continue;
+        }
+        
+        // Updating, the worker notifies again once done
+        std::unique_lock<std::mutex> c_Lock(p_Hosted->c_Mutex, std::try_to_lock);
+        
+        if (c_Lock.owns_lock() == false)
+        {
+            continue;
+        }
+        
+        // A failed service only sends what was recieved before
+        PackageService::ServiceEventContainer* p_Container;
+        
+        if (p_Hosted->b_Failed.load(std::memory_order_relaxed) == true)
+        {
+            p_Container = p_Hosted->p_Service->GetRemainingEvents();
+        }
+        else
+        {
+            p_Container = p_Hosted->p_Service->RecieveEvents();
+        }
+        
+        p_EventHandler->SendEvents(p_Container);
+        
+        // Left for the next send, the output wakes us
+        if (p_Container->GetEventCount() > 0)
+        {
+            p_Hosted->b_Events.store(true, std::memory_order_relaxed);
+        }
+    }
+    
+    us_NextService = (us_NextService + 1) % us_Count;
+}
+
+bool ServiceHost::Drain(EventHandler* p_EventHandler, MRH_Uint32 u32_DeadlineMS) noexcept
+{
+    MRH_Uint64 u64_Deadline = Metrics::GetTimeNS() + static_cast<MRH_Uint64>(u32_DeadlineMS) * 1000000;
+    MRH_Uint64 u64_Time;
+    
+    // @NOTE: Workers are stopped, no service is locked
+    for (auto& Hosted : v_Service)
+    {
+        if ((u64_Time = Metrics::GetTimeNS()) >= u64_Deadline ||
+            p_EventHandler->Drain(Hosted->p_Service->GetRemainingEvents(), static_cast<MRH_Uint32>((u64_Deadline - u64_Time) / 1000000)) == false)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+//*************************************************************************************
+// Stop
+//*************************************************************************************
+
+void ServiceHost::Stop() noexcept
+{
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        
+        b_Run = false;
+    }
+    
+    c_Condition.notify_all();
+    
+    // Queued updates are dropped, the services exit next
+    for (auto& Worker : v_Worker)
+    {
+        if (Worker->c_Thread.joinable() == true)
+        {
+            Worker->c_Thread.join();
+        }
+        
+        delete Worker;
+    }
+    
+    v_Worker.clear();
+    
+    // Only initialized services are running, exit once
+    for (auto& Hosted : v_Service)
+    {
+        if (Hosted->b_Initialized == true)
+        {
+            Hosted->p_Service->Exit();
+            Hosted->b_Initialized = false;
+        }
+    }
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+MRH_Uint64 ServiceHost::GetNextUpdateNS() noexcept
+{
+    MRH_Uint64 u64_Next;
+    
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        
+        if (c_TimerWheel.GetNextDeadline(u64_Next) == true)
+        {
+            return u64_Next;
+        }
+    }
+    
+    return Metrics::GetTimeNS() + u64_IdleWaitNS;
+}
+
+size_t ServiceHost::GetRunningCount() noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    return std::count_if(v_Service.begin(), v_Service.end(), [](HostedService* p_Hosted)
+    {
+        return p_Hosted->b_Failed == false;
+    });
+}
+
+size_t ServiceHost::GetWorkerCount() const noexcept
+{
+    return v_Worker.size();
+}
+
+PackageService* ServiceHost::GetFirstService() noexcept
+{
+    return v_Service[0]->p_Service;
+}
@@ -0,0 +1,309 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef ServiceHost_h
+#define ServiceHost_h
+
+// C / C++
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// External
+
+// Project
+#include "./Package/PackageService.h"
+#include "./Event/EventHandler.h"
+#include "./Scheduler.h"
+#include "./TimerWheel.h"
+
+
+class ServiceHost
+{
+public:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor. All packages have to use the same user and group id.
+     *
+     *  \param v_PackagePath The full paths to the application packages.
+     *  \param p_EventLimit The max amount of event to be sent in a update, per package.
+     *  \param p_Scheduler The scheduler woken for updates and events.
+     */
+    
+    ServiceHost(std::vector<const char*> const& v_PackagePath,
+                const char* p_EventLimit,
+                Scheduler* p_Scheduler);
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_ServiceHost ServiceHost class source.
+     */
+    
+    ServiceHost(ServiceHost const& c_ServiceHost) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~ServiceHost() noexcept;
+    
+    //*************************************************************************************
+    // Init
+    //*************************************************************************************
+    
+    /**
+     *  Start reading the shared objects of all services with preloading enabled 
+     *  into the page cache.
+     */
+    
+    void Preload() noexcept;
+    
+    /**
+     *  Load and initialize all application services, then start the workers. 
+     *  The service init functions run at the same time. Every worker has its 
+     *  own run queue and is pinned to its own core if enough cores are 
+     *  available.
+     *
+     *  \param us_WorkerCount The amount of worker threads to update services with, 0 
+     *                        for one per package up to the amount of cores.
+     */
+    
+    void Init(size_t us_WorkerCount);
+    
+    /**
+     *  Set the transport the events of all services are sent with.
+     *
+     *  \param p_Transport The transport to watch.
+     */
+    
+    void SetOutput(EventTransport const* p_Transport) noexcept;
+    
+    //*************************************************************************************
+    // Update
+    //*************************************************************************************
+    
+    /**
+     *  Add all services with a due update to the run queue of the worker which 
+     *  updated them last.
+     */
+    
+    void DispatchUpdates() noexcept;
+    
+    //*************************************************************************************
+    // Send
+    //*************************************************************************************
+    
+    /**
+     *  Recieve and send events of all services which have events ready or events 
+     *  left from a previous send.
+     *
+     *  \param p_EventHandler The event handler to send with.
+     */
+    
+    void SendEvents(EventHandler* p_EventHandler) noexcept;
+    
+    /**
+     *  Send all remaining events of stopped services.
+     *
+     *  \param p_EventHandler The event handler to send with.
+     *  \param u32_DeadlineMS The max time to wait in milliseconds.
+     *
+     *  \return true if all events were sent, false if the deadline was reached.
+     */
+    
+    bool Drain(EventHandler* p_EventHandler, MRH_Uint32 u32_DeadlineMS) noexcept;
+    
+    //*************************************************************************************
+    // Stop
+    //*************************************************************************************
+    
+    /**
+     *  Stop the workers and exit all application services.
+     */
+    
+    void Stop() noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the deadline of the next service update.
+     *
+     *  \return The monotonic clock deadline in nanoseconds.
+     */
+    
+    MRH_Uint64 GetNextUpdateNS() noexcept;
+    
+    /**
+     *  Get the amount of services which did not fail.
+     *
+     *  \return The running service count.
+     */
+    
+    size_t GetRunningCount() noexcept;
+    
+    /**
+     *  Get the amount of worker threads.
+     *
+     *  \return The worker count.
+     */
+    
+    size_t GetWorkerCount() const noexcept;
+    
+    /**
+     *  Get the first hosted service. Its settings are used for the host.
+     *
+     *  \return The first service.
+     */
+    
+    PackageService* GetFirstService() noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    struct HostedService
+    {
+        // Service, locked while called
+        PackageService* p_Service;
+        std::string s_PackagePath;
+        std::mutex c_Mutex;
+        
+        bool b_Initialized;
+        
+        // Schedule, guarded by the host mutex
+        TimerWheel::Entry c_Timer; // Armed while not queued or updating
+        MRH_Uint64 u64_NextUpdateNS; // Deadline, also the run queue order
+        size_t us_Worker; // Run queue for the next update
+        
+        // State, read without locking
+        std::atomic<bool> b_Failed;
+        std::atomic<bool> b_Events; // Events to recieve or left unsent
+        
+        // Notification target
+        ServiceHost* p_Host;
+    };
+    
+    struct Worker
+    {
+        // Run queue, a heap ordered by deadline
+        std::mutex c_Mutex;
+        std::vector<HostedService*> v_Queue;
+        bool b_Busy; // Updating, queued services can be stolen
+        
+        // Thread
+        std::thread c_Thread;
+        size_t us_Index;
+        ServiceHost* p_Host;
+    };
+    
+    //*************************************************************************************
+    // Notify
+    //*************************************************************************************
+    
+    /**
+     *  Notify the host that a service has events ready to be recieved. This 
+     *  function is meant to be given to the application service as a callback.
+     *
+     *  \param p_HostedService The hosted service with events.
+     */
+    
+    static void NotifyEvents(void* p_HostedService) noexcept;
+    
+    //*************************************************************************************
+    // Run
+    //*************************************************************************************
+    
+    /**
+     *  Worker thread function.
+     *
+     *  \param p_Worker The worker to run.
+     */
+    
+    static void Run(Worker* p_Worker) noexcept;
+    
+    /**
+     *  Take the service with the earliest deadline from the own run queue. 
+     *  Services are stolen from busy workers if the own queue is empty.
+     *
+     *  \param p_Worker The worker to take a service for.
+     *
+     *  \return The service to update on success, NULL if nothing is queued.
+     */
+    
+    HostedService* Take(Worker* p_Worker) noexcept;
+    
+    /**
+     *  Update a service and recieve the events of the update.
+     *
+     *  \param p_Worker The worker updating the service.
+     *  \param p_Hosted The service to update.
+     */
+    
+    void Update(Worker* p_Worker, HostedService* p_Hosted) noexcept;
+    
+    /**
+     *  Wake all idle workers to check the run queues again.
+     */
+    
+    void WakeWorkers() noexcept;
+    
+    /**
+     *  Check if a service is due before another. Used to order the run queues.
+     *
+     *  \param p_A The first service.
+     *  \param p_B The second service.
+     *
+     *  \return true if the first service is due later, false if not.
+     */
+    
+    static bool CompareDeadline(HostedService const* p_A, HostedService const* p_B) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Services
+    std::vector<HostedService*> v_Service;
+    size_t us_NextService;
+    Scheduler* p_Scheduler;
+    
+    // Update deadlines, guarded by the host mutex
+    TimerWheel c_TimerWheel;
+    
+    // Workers
+    std::vector<Worker*> v_Worker;
+    std::mutex c_Mutex;
+    std::condition_variable c_Condition;
+    MRH_Uint64 u64_Wake; // Changed on new work, idle workers wait for it
+    bool b_Run;
+
+protected:
+
+};
+
+#endif /* ServiceHost_h */
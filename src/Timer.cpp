@@ -45,7 +45,7 @@ Timer::~Timer() noexcept
 
 void Timer::Reset() noexcept
 {
-    c_StartTime = std::chrono::high_resolution_clock::now();
+    c_StartTime = std::chrono::steady_clock::now();
 }
 
 //*************************************************************************************
@@ -59,10 +59,11 @@ Timer::TimePoint Timer::GetStartTimePoint() const noexcept
 
 double Timer::GetTimePassedSeconds() const noexcept
 {
-    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - c_StartTime).count();
+    // @NOTE: No cast to whole seconds, sub-second waits would round to 0
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - c_StartTime).count();
 }
 
 double Timer::GetTimePassedMilliseconds() const noexcept
 {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - c_StartTime).count();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c_StartTime).count();
 }
@@ -33,7 +33,7 @@ public:
     // Types
     //*************************************************************************************
     
-    typedef std::chrono::high_resolution_clock::time_point TimePoint;
+    typedef std::chrono::steady_clock::time_point TimePoint;
     
     //*************************************************************************************
     // Constructor / Destructor
@@ -76,7 +76,7 @@ public:
     /**
      *  Get the start time point.
      *
-     *  \return The high resolution start time point.
+     *  \return The steady start time point.
      */
     
     TimePoint GetStartTimePoint() const noexcept;
@@ -84,7 +84,8 @@ public:
     /**
      *  Get the time passed in seconds.
      *
-     *  \return The time passed in seconds from the start time point to now.
+     *  \return The time passed in seconds from the start time point to now, 
+     *          including fractions.
      */
     
     double GetTimePassedSeconds() const noexcept;
@@ -92,7 +93,8 @@ public:
     /**
      *  Get the time passed in milliseconds.
      *
-     *  \return The time passed in milliseconds from the start time point to now.
+     *  \return The time passed in milliseconds from the start time point to now, 
+     *          including fractions.
      */
     
     double GetTimePassedMilliseconds() const noexcept;
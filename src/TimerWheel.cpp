@@ -0,0 +1,405 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <ctime>
+
+// External
+
+// Project
+#include "./TimerWheel.h"
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+TimerWheel::TimerWheel(MRH_Uint64 u64_TickNS) noexcept : u64_TickNS(u64_TickNS > 0 ? u64_TickNS : 1),
+                                                         p_Current(NULL),
+                                                         p_Overflow(NULL),
+                                                         us_Armed(0)
+{
+    // Start at the current time, a tick of 0 would cascade from boot
+    struct timespec c_Time;
+    clock_gettime(CLOCK_MONOTONIC, &c_Time);
+    
+    u64_Tick = (static_cast<MRH_Uint64>(c_Time.tv_sec) * 1000000000ULL + static_cast<MRH_Uint64>(c_Time.tv_nsec)) / this->u64_TickNS;
+    
+    for (size_t i = 0; i < us_LevelCount; ++i)
+    {
+        for (size_t j = 0; j < us_SlotCount; ++j)
+        {
+            p_Slot[i][j] = NULL;
+        }
+        
+        p_Occupied[i] = 0;
+    }
+}
+
+TimerWheel::~TimerWheel() noexcept
+{}
+
+//*************************************************************************************
+// Entry
+//*************************************************************************************
+
+void TimerWheel::InitEntry(Entry& c_Entry, void* p_Data) noexcept
+{
+    c_Entry.p_Data = p_Data;
+    c_Entry.p_Next = NULL;
+    c_Entry.p_Prev = NULL;
+    c_Entry.u64_DeadlineNS = 0;
+    c_Entry.us_Level = 0;
+    c_Entry.us_Slot = 0;
+    c_Entry.b_Armed = false;
+}
+
+//*************************************************************************************
+// Slot
+//*************************************************************************************
+
+void TimerWheel::Insert(Entry* p_Entry) noexcept
+{
+    MRH_Uint64 u64_EntryTick = p_Entry->u64_DeadlineNS / u64_TickNS;
+    Entry** p_Head;
+    
+    if (u64_EntryTick <= u64_Tick)
+    {
+        p_Entry->us_Level = us_LevelCurrent;
+        p_Entry->us_Slot = 0;
+        p_Head = &p_Current;
+    }
+    else if ((u64_EntryTick >> (us_SlotBits * (us_LevelCount - 1))) - (u64_Tick >> (us_SlotBits * (us_LevelCount - 1))) >= us_SlotCount)
+    {
+        // Beyond the wheel, placed again once the highest level turns
+        p_Entry->us_Level = us_LevelOverflow;
+        p_Entry->us_Slot = 0;
+        p_Head = &p_Overflow;
+    }
+    else
+    {
+        // Lowest level with the deadline inside its range
+        size_t us_Level = 0;
+        
+        while ((u64_EntryTick >> (us_SlotBits * us_Level)) - (u64_Tick >> (us_SlotBits * us_Level)) >= us_SlotCount)
+        {
+            ++us_Level;
+        }
+        
+        p_Entry->us_Level = us_Level;
+        p_Entry->us_Slot = static_cast<size_t>((u64_EntryTick >> (us_SlotBits * us_Level)) & (us_SlotCount - 1));
+        p_Head = &(p_Slot[us_Level][p_Entry->us_Slot]);
+        
+        p_Occupied[us_Level] |= 1ULL << p_Entry->us_Slot;
+    }
+    
+    p_Entry->p_Prev = NULL;
+    p_Entry->p_Next = *p_Head;
+    
+    if (*p_Head != NULL)
+    {
+        (*p_Head)->p_Prev = p_Entry;
+    }
+    
+    *p_Head = p_Entry;
+}
+
+void TimerWheel::Remove(Entry* p_Entry) noexcept
+{
+    Entry** p_Head;
+    
+    switch (p_Entry->us_Level)
+    {
+        case us_LevelCurrent:
+            p_Head = &p_Current;
+            break;
+        case us_LevelOverflow:
+            p_Head = &p_Overflow;
+            break;
+        default:
+            p_Head = &(p_Slot[p_Entry->us_Level][p_Entry->us_Slot]);
+            break;
+    }
+    
+    if (p_Entry->p_Prev != NULL)
+    {
+        p_Entry->p_Prev->p_Next = p_Entry->p_Next;
+    }
+    else
+    {
+        *p_Head = p_Entry->p_Next;
+    }
+    
+    if (p_Entry->p_Next != NULL)
+    {
+        p_Entry->p_Next->p_Prev = p_Entry->p_Prev;
+    }
+    
+    if (*p_Head == NULL && p_Entry->us_Level < us_LevelCount)
+    {
+        p_Occupied[p_Entry->us_Level] &= ~(1ULL << p_Entry->us_Slot);
+    }
+    
+    p_Entry->p_Next = NULL;
+    p_Entry->p_Prev = NULL;
+}
+
+size_t TimerWheel::GetNextSlot(size_t us_Level, MRH_Uint64& u64_Tick) const noexcept
+{
+    MRH_Uint64 u64_Mask = p_Occupied[us_Level];
+    
+    if (u64_Mask == 0)
+    {
+        return us_SlotCount;
+    }
+    
+    // Rotate so that bit 0 is the block after the current one
+    MRH_Uint64 u64_CurrentBlock = this->u64_Tick >> (us_SlotBits * us_Level);
+    size_t us_Start = static_cast<size_t>((u64_CurrentBlock + 1) & (us_SlotCount - 1));
+    
+    if (us_Start > 0)
+    {
+        u64_Mask = (u64_Mask >> us_Start) | (u64_Mask << (us_SlotCount - us_Start));
+    }
+    
+    MRH_Uint64 u64_Block = u64_CurrentBlock + 1 + static_cast<MRH_Uint64>(__builtin_ctzll(u64_Mask));
+    u64_Tick = u64_Block << (us_SlotBits * us_Level);
+    
+    return static_cast<size_t>(u64_Block & (us_SlotCount - 1));
+}
+
+//*************************************************************************************
+// Schedule
+//*************************************************************************************
+
+void TimerWheel::Schedule(Entry& c_Entry, MRH_Uint64 u64_DeadlineNS) noexcept
+{
+    if (c_Entry.b_Armed == true)
+    {
+        Remove(&c_Entry);
+    }
+    else
+    {
+        c_Entry.b_Armed = true;
+        ++us_Armed;
+    }
+    
+    c_Entry.u64_DeadlineNS = u64_DeadlineNS;
+    Insert(&c_Entry);
+}
+
+void TimerWheel::Cancel(Entry& c_Entry) noexcept
+{
+    if (c_Entry.b_Armed == false)
+    {
+        return;
+    }
+    
+    Remove(&c_Entry);
+    
+    c_Entry.b_Armed = false;
+    --us_Armed;
+}
+
+MRH_Uint64 TimerWheel::GetPeriodDeadline(MRH_Uint64 u64_DeadlineNS, MRH_Uint64 u64_PeriodNS, MRH_Uint64 u64_NowNS) noexcept
+{
+    if (u64_PeriodNS == 0)
+    {
+        return u64_NowNS;
+    }
+    
+    u64_DeadlineNS += u64_PeriodNS;
+    
+    // Overran, keep the phase but do not catch up
+    if (u64_DeadlineNS <= u64_NowNS)
+    {
+        u64_DeadlineNS += ((u64_NowNS - u64_DeadlineNS) / u64_PeriodNS + 1) * u64_PeriodNS;
+    }
+    
+    return u64_DeadlineNS;
+}
+
+//*************************************************************************************
+// Expire
+//*************************************************************************************
+
+TimerWheel::Entry* TimerWheel::Expire(MRH_Uint64 u64_NowNS) noexcept
+{
+    MRH_Uint64 u64_Now = u64_NowNS / u64_TickNS;
+    
+    if (us_Armed == 0)
+    {
+        if (u64_Now > u64_Tick)
+        {
+            u64_Tick = u64_Now;
+        }
+        
+        return NULL;
+    }
+    
+    while (u64_Tick < u64_Now)
+    {
+        // Jump to the next tick with a occupied slot, nothing happens between
+        MRH_Uint64 u64_Next = u64_Now;
+        MRH_Uint64 u64_SlotTick;
+        
+        for (size_t i = 0; i < us_LevelCount; ++i)
+        {
+            if (GetNextSlot(i, u64_SlotTick) < us_SlotCount && u64_SlotTick < u64_Next)
+            {
+                u64_Next = u64_SlotTick;
+            }
+        }
+        
+        if (p_Overflow != NULL)
+        {
+            u64_SlotTick = ((u64_Tick >> (us_SlotBits * (us_LevelCount - 1))) + 1) << (us_SlotBits * (us_LevelCount - 1));
+            
+            if (u64_SlotTick < u64_Next)
+            {
+                u64_Next = u64_SlotTick;
+            }
+        }
+        
+        u64_Tick = u64_Next;
+        
+        // The wheel range moved, overflow timers might fit now
+        if (p_Overflow != NULL && (u64_Tick & ((1ULL << (us_SlotBits * (us_LevelCount - 1))) - 1)) == 0)
+        {
+            Entry* p_Entry = p_Overflow;
+            p_Overflow = NULL;
+            
+            while (p_Entry != NULL)
+            {
+                Entry* p_Next = p_Entry->p_Next;
+                Insert(p_Entry);
+                p_Entry = p_Next;
+            }
+        }
+        
+        // Cascade the slots starting here, highest level first
+        for (size_t i = us_LevelCount - 1; i > 0; --i)
+        {
+            if ((u64_Tick & ((1ULL << (us_SlotBits * i)) - 1)) != 0)
+            {
+                continue;
+            }
+            
+            size_t us_Slot = static_cast<size_t>((u64_Tick >> (us_SlotBits * i)) & (us_SlotCount - 1));
+            Entry* p_Entry = p_Slot[i][us_Slot];
+            
+            p_Slot[i][us_Slot] = NULL;
+            p_Occupied[i] &= ~(1ULL << us_Slot);
+            
+            while (p_Entry != NULL)
+            {
+                Entry* p_Next = p_Entry->p_Next;
+                Insert(p_Entry);
+                p_Entry = p_Next;
+            }
+        }
+        
+        // Due at this tick, moved to the current timers
+        size_t us_Slot = static_cast<size_t>(u64_Tick & (us_SlotCount - 1));
+        Entry* p_Entry = p_Slot[0][us_Slot];
+        
+        p_Slot[0][us_Slot] = NULL;
+        p_Occupied[0] &= ~(1ULL << us_Slot);
+        
+        while (p_Entry != NULL)
+        {
+            Entry* p_Next = p_Entry->p_Next;
+            Insert(p_Entry);
+            p_Entry = p_Next;
+        }
+    }
+    
+    // The last tick might only be partially over
+    Entry* p_Expired = NULL;
+    Entry* p_Entry = p_Current;
+    
+    while (p_Entry != NULL)
+    {
+        Entry* p_Next = p_Entry->p_Next;
+        
+        if (p_Entry->u64_DeadlineNS <= u64_NowNS)
+        {
+            Remove(p_Entry);
+            
+            p_Entry->b_Armed = false;
+            p_Entry->p_Next = p_Expired;
+            p_Expired = p_Entry;
+            
+            --us_Armed;
+        }
+        
+        p_Entry = p_Next;
+    }
+    
+    return p_Expired;
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+bool TimerWheel::GetNextDeadline(MRH_Uint64& u64_DeadlineNS) const noexcept
+{
+    if (us_Armed == 0)
+    {
+        return false;
+    }
+    
+    Entry* p_Entry;
+    MRH_Uint64 u64_SlotTick;
+    bool b_Found = false;
+    
+    // Slots of a level are in deadline order, only the first one is checked
+    for (size_t i = 0; i <= us_LevelOverflow; ++i)
+    {
+        if (i == us_LevelCurrent)
+        {
+            p_Entry = p_Current;
+        }
+        else if (i == us_LevelOverflow)
+        {
+            // Always later than the wheel timers
+            p_Entry = b_Found == false ? p_Overflow : NULL;
+        }
+        else
+        {
+            size_t us_Slot = GetNextSlot(i, u64_SlotTick);
+            p_Entry = us_Slot < us_SlotCount ? p_Slot[i][us_Slot] : NULL;
+        }
+        
+        for (; p_Entry != NULL; p_Entry = p_Entry->p_Next)
+        {
+            if (b_Found == false || p_Entry->u64_DeadlineNS < u64_DeadlineNS)
+            {
+                u64_DeadlineNS = p_Entry->u64_DeadlineNS;
+                b_Found = true;
+            }
+        }
+    }
+    
+    return b_Found;
+}
+
+size_t TimerWheel::GetArmedCount() const noexcept
+{
+    return us_Armed;
+}
@@ -0,0 +1,237 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef TimerWheel_h
+#define TimerWheel_h
+
+// C / C++
+#include <cstddef>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+
+
+class TimerWheel
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // @NOTE: Owned by the user, managed by the wheel while armed
+    struct Entry
+    {
+        // User data
+        void* p_Data;
+        
+        // Wheel data, do not change
+        Entry* p_Next;
+        Entry* p_Prev;
+        MRH_Uint64 u64_DeadlineNS;
+        size_t us_Level;
+        size_t us_Slot;
+        bool b_Armed;
+    };
+    
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     *
+     *  \param u64_TickNS The wheel resolution in nanoseconds. Deadlines stay exact, 
+     *                    the resolution only decides the slot of a timer.
+     */
+    
+    TimerWheel(MRH_Uint64 u64_TickNS = 1000000) noexcept;
+    
+    /**
+     *  Copy constructor. Disabled for this class.
+     *
+     *  \param c_TimerWheel TimerWheel class source.
+     */
+    
+    TimerWheel(TimerWheel const& c_TimerWheel) = delete;
+    
+    /**
+     *  Default destructor.
+     */
+    
+    ~TimerWheel() noexcept;
+    
+    //*************************************************************************************
+    // Entry
+    //*************************************************************************************
+    
+    /**
+     *  Initialize a timer entry. Entries have to be initialized once before use.
+     *
+     *  \param c_Entry The entry to initialize.
+     *  \param p_Data The user data of the entry.
+     */
+    
+    static void InitEntry(Entry& c_Entry, void* p_Data) noexcept;
+    
+    //*************************************************************************************
+    // Schedule
+    //*************************************************************************************
+    
+    /**
+     *  Arm a timer for a absolute deadline. A armed timer is moved to the new 
+     *  deadline. This function runs in constant time.
+     *
+     *  \param c_Entry The timer entry to arm.
+     *  \param u64_DeadlineNS The monotonic clock deadline in nanoseconds.
+     */
+    
+    void Schedule(Entry& c_Entry, MRH_Uint64 u64_DeadlineNS) noexcept;
+    
+    /**
+     *  Disarm a timer. This function runs in constant time.
+     *
+     *  \param c_Entry The timer entry to disarm.
+     */
+    
+    void Cancel(Entry& c_Entry) noexcept;
+    
+    /**
+     *  Get the next deadline of a periodic timer. The deadline follows the last 
+     *  deadline instead of the current time to avoid drift, missed periods are 
+     *  skipped.
+     *
+     *  \param u64_DeadlineNS The last deadline in nanoseconds.
+     *  \param u64_PeriodNS The period in nanoseconds.
+     *  \param u64_NowNS The current monotonic clock time in nanoseconds.
+     *
+     *  \return The next deadline in nanoseconds.
+     */
+    
+    static MRH_Uint64 GetPeriodDeadline(MRH_Uint64 u64_DeadlineNS, MRH_Uint64 u64_PeriodNS, MRH_Uint64 u64_NowNS) noexcept;
+    
+    //*************************************************************************************
+    // Expire
+    //*************************************************************************************
+    
+    /**
+     *  Disarm all timers with a deadline up to the given time. Empty slots are 
+     *  skipped, the cost only depends on the amount of timers moved.
+     *
+     *  \param u64_NowNS The current monotonic clock time in nanoseconds.
+     *
+     *  \return The expired entries linked by p_Next, NULL if none expired. Read 
+     *          p_Next before scheduling a expired entry again.
+     */
+    
+    Entry* Expire(MRH_Uint64 u64_NowNS) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the earliest deadline of all armed timers.
+     *
+     *  \param u64_DeadlineNS The deadline in nanoseconds, set if a timer is armed.
+     *
+     *  \return true if a timer is armed, false if not.
+     */
+    
+    bool GetNextDeadline(MRH_Uint64& u64_DeadlineNS) const noexcept;
+    
+    /**
+     *  Get the amount of armed timers.
+     *
+     *  \return The armed timer count.
+     */
+    
+    size_t GetArmedCount() const noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    // @NOTE: One bit per slot in the occupied mask
+    static constexpr size_t us_SlotBits = 6;
+    static constexpr size_t us_SlotCount = 1 << us_SlotBits;
+    static constexpr size_t us_LevelCount = 4;
+    
+    // Timer lists outside of the slots
+    static constexpr size_t us_LevelCurrent = us_LevelCount;
+    static constexpr size_t us_LevelOverflow = us_LevelCount + 1;
+    
+    //*************************************************************************************
+    // Slot
+    //*************************************************************************************
+    
+    /**
+     *  Add a entry to the slot matching its deadline.
+     *
+     *  \param p_Entry The entry to add.
+     */
+    
+    void Insert(Entry* p_Entry) noexcept;
+    
+    /**
+     *  Remove a entry from its slot.
+     *
+     *  \param p_Entry The entry to remove.
+     */
+    
+    void Remove(Entry* p_Entry) noexcept;
+    
+    /**
+     *  Get the first occupied slot of a level after the current tick.
+     *
+     *  \param us_Level The level to check.
+     *  \param u64_Tick The tick the slot starts at, set if a slot is occupied.
+     *
+     *  \return The slot on success, us_SlotCount if the level is empty.
+     */
+    
+    size_t GetNextSlot(size_t us_Level, MRH_Uint64& u64_Tick) const noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Resolution
+    MRH_Uint64 u64_TickNS;
+    MRH_Uint64 u64_Tick; // All slots up to this tick are expired
+    
+    // Slots, each level covers the full range of the level below per slot
+    Entry* p_Slot[us_LevelCount][us_SlotCount];
+    MRH_Uint64 p_Occupied[us_LevelCount];
+    
+    // Timers inside the current tick, checked by their exact deadline
+    Entry* p_Current;
+    
+    // Timers beyond the highest level
+    Entry* p_Overflow;
+    
+    size_t us_Armed;
+
+protected:
+
+};
+
+#endif /* TimerWheel_h */
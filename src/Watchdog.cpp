@@ -0,0 +1,268 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+// C / C++
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+// External
+
+// Project
+#include "./Watchdog.h"
+#include "./Logger.h"
+#include "./Metrics.h"
+
+// Pre-defined
+namespace
+{
+    // Check interval bounds, checks run at a quarter of the smallest limit
+    constexpr MRH_Uint64 u64_MinIntervalNS = 10000000;
+    constexpr MRH_Uint64 u64_MaxIntervalNS = 1000000000;
+    
+    // Time given to the crash handler of the stuck thread before aborting here
+    constexpr MRH_Uint64 u64_AbortGraceNS = 1000000000;
+    
+    const char* p_CallbackName[Watchdog::CALLBACK_COUNT] =
+    {
+        "MRH_Init",
+        "MRH_Update",
+        "MRH_SendEvent",
+        "MRH_Exit"
+    };
+}
+
+
+//*************************************************************************************
+// Constructor / Destructor
+//*************************************************************************************
+
+Watchdog::Watchdog() noexcept : u64_IntervalNS(u64_MaxIntervalNS),
+                                b_Run(false)
+{}
+
+Watchdog::~Watchdog() noexcept
+{
+    {
+        std::lock_guard<std::mutex> c_Guard(c_Mutex);
+        b_Run = false;
+    }
+    
+    c_Condition.notify_all();
+    
+    if (c_Thread.joinable() == true)
+    {
+        c_Thread.join();
+    }
+}
+
+//*************************************************************************************
+// Singleton
+//*************************************************************************************
+
+Watchdog& Watchdog::Singleton() noexcept
+{
+    static Watchdog c_Watchdog;
+    return c_Watchdog;
+}
+
+//*************************************************************************************
+// Watch
+//*************************************************************************************
+
+void Watchdog::InitWatch(Watch& c_Watch, std::string const& s_Name, MRH_Uint32 u32_SoftLimitMS, MRH_Uint32 u32_HardLimitMS) noexcept
+{
+    try
+    {
+        c_Watch.s_Name = s_Name;
+    }
+    catch (...)
+    {}
+    
+    c_Watch.u64_SoftLimitNS = static_cast<MRH_Uint64>(u32_SoftLimitMS) * 1000000;
+    c_Watch.u64_HardLimitNS = static_cast<MRH_Uint64>(u32_HardLimitMS) * 1000000;
+    c_Watch.u64_StartNS = 0;
+    c_Watch.i_Callback = CALLBACK_INIT;
+    c_Watch.c_Thread = pthread_self();
+    c_Watch.u64_SampledNS = 0;
+    c_Watch.u64_AbortNS = 0;
+}
+
+void Watchdog::Add(Watch* p_Watch)
+{
+    if (p_Watch == NULL || (p_Watch->u64_SoftLimitNS == 0 && p_Watch->u64_HardLimitNS == 0))
+    {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    try
+    {
+        v_Watch.emplace_back(p_Watch);
+    }
+    catch (std::exception& e)
+    {
+        throw Exception("Failed to add watchdog watch: " + std::string(e.what()));
+    }
+    
+    // Checked often enough to stay close to the smallest limit
+    for (MRH_Uint64 u64_Limit : { p_Watch->u64_SoftLimitNS, p_Watch->u64_HardLimitNS })
+    {
+        if (u64_Limit > 0)
+        {
+            u64_IntervalNS = std::min(u64_IntervalNS, std::max(u64_Limit / 4, u64_MinIntervalNS));
+        }
+    }
+    
+    if (b_Run == true)
+    {
+        return;
+    }
+    
+    try
+    {
+        b_Run = true;
+        c_Thread = std::thread(Watchdog::Run, this);
+    }
+    catch (std::exception& e)
+    {
+        b_Run = false;
+        v_Watch.pop_back();
+        
+        throw Exception("Failed to start watchdog thread: " + std::string(e.what()));
+    }
+}
+
+void Watchdog::Remove(Watch* p_Watch) noexcept
+{
+    std::lock_guard<std::mutex> c_Guard(c_Mutex);
+    
+    auto Watch = std::find(v_Watch.begin(), v_Watch.end(), p_Watch);
+    
+    if (Watch != v_Watch.end())
+    {
+        v_Watch.erase(Watch);
+    }
+}
+
+//*************************************************************************************
+// Callback
+//*************************************************************************************
+
+void Watchdog::Enter(Watch& c_Watch, Callback e_Callback) noexcept
+{
+    c_Watch.c_Thread.store(pthread_self(), std::memory_order_relaxed);
+    c_Watch.i_Callback.store(e_Callback, std::memory_order_relaxed);
+    
+    // Publishes the thread and callback
+    c_Watch.u64_StartNS.store(Metrics::GetTimeNS(), std::memory_order_release);
+}
+
+void Watchdog::Leave(Watch& c_Watch) noexcept
+{
+    c_Watch.u64_StartNS.store(0, std::memory_order_release);
+}
+
+//*************************************************************************************
+// Run
+//*************************************************************************************
+
+void Watchdog::Run(Watchdog* p_Instance) noexcept
+{
+    std::unique_lock<std::mutex> c_Lock(p_Instance->c_Mutex);
+    
+    while (p_Instance->b_Run == true)
+    {
+        p_Instance->c_Condition.wait_for(c_Lock, std::chrono::nanoseconds(p_Instance->u64_IntervalNS));
+        
+        if (p_Instance->b_Run == true)
+        {
+            p_Instance->Check(Metrics::GetTimeNS());
+        }
+    }
+}
+
+void Watchdog::Check(MRH_Uint64 u64_NowNS) noexcept
+{
+    for (auto& Watch : v_Watch)
+    {
+        MRH_Uint64 u64_Start = Watch->u64_StartNS.load(std::memory_order_acquire);
+        
+        if (u64_Start == 0 || u64_Start >= u64_NowNS)
+        {
+            continue;
+        }
+        
+        pthread_t c_Thread = Watch->c_Thread.load(std::memory_order_relaxed);
+        Callback e_Callback = static_cast<Callback>(Watch->i_Callback.load(std::memory_order_relaxed));
+        
+        // Finished or replaced while reading, the next check sees the new call
+        if (Watch->u64_StartNS.load(std::memory_order_acquire) != u64_Start)
+        {
+            continue;
+        }
+        
+        MRH_Uint64 u64_RunningMS = (u64_NowNS - u64_Start) / 1000000;
+        
+        if (Watch->u64_HardLimitNS > 0 && u64_NowNS - u64_Start >= Watch->u64_HardLimitNS)
+        {
+            if (Watch->u64_AbortNS == 0)
+            {
+                MRH_LOG_ERROR(Watch->s_Name, ": ", GetCallbackName(e_Callback), " running for ", u64_RunningMS, 
+                              " ms, hard limit reached! Aborting.");
+                
+                // The crash handler runs on the stuck thread, the backtrace shows it
+                // @NOTE: The call might have finished while logging, only 
+                //        signal the thread if it is still in the same call
+                if (Watch->u64_StartNS.load(std::memory_order_acquire) == u64_Start)
+                {
+                    Watch->u64_AbortNS = u64_NowNS;
+                    pthread_kill(c_Thread, SIGABRT);
+                }
+            }
+            else if (u64_NowNS - Watch->u64_AbortNS >= u64_AbortGraceNS)
+            {
+                MRH_LOG_ERROR(Watch->s_Name, ": Stuck thread did not abort, aborting from the watchdog!");
+                std::abort();
+            }
+        }
+        else if (Watch->u64_SoftLimitNS > 0 && u64_NowNS - u64_Start >= Watch->u64_SoftLimitNS && Watch->u64_SampledNS != u64_Start)
+        {
+            MRH_LOG_WARNING(Watch->s_Name, ": ", GetCallbackName(e_Callback), " running for ", u64_RunningMS, 
+                            " ms, stack sample written to the backtrace file.");
+            
+            // Once per call, a stuck call is not sampled again
+            Watch->u64_SampledNS = u64_Start;
+            Metrics::Singleton().Add(Metrics::COUNTER_WATCHDOG_SAMPLES, 1);
+            
+            if (Watch->u64_StartNS.load(std::memory_order_acquire) == u64_Start)
+            {
+                pthread_kill(c_Thread, i_SampleSignal);
+            }
+        }
+    }
+}
+
+//*************************************************************************************
+// Getters
+//*************************************************************************************
+
+const char* Watchdog::GetCallbackName(Callback e_Callback) noexcept
+{
+    return e_Callback < CALLBACK_COUNT ? p_CallbackName[e_Callback] : "Unknown";
+}
@@ -0,0 +1,217 @@
+/**
+ *  Copyright (C) 2021 - 2022 The MRH Project Authors.
+ * 
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef Watchdog_h
+#define Watchdog_h
+
+// C / C++
+#include <pthread.h>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// External
+#include <MRH_Typedefs.h>
+
+// Project
+#include "./Exception.h"
+
+
+class Watchdog
+{
+public:
+
+    //*************************************************************************************
+    // Types
+    //*************************************************************************************
+    
+    typedef enum
+    {
+        CALLBACK_INIT = 0,
+        CALLBACK_UPDATE = 1,
+        CALLBACK_SEND_EVENT = 2,
+        CALLBACK_EXIT = 3,
+        
+        CALLBACK_MAX = CALLBACK_EXIT,
+        
+        CALLBACK_COUNT = CALLBACK_MAX + 1
+    
+    }Callback;
+    
+    // Sent to a stuck thread, the handler has to call Logger::StackSample()
+    static constexpr int i_SampleSignal = SIGUSR2;
+    
+    struct Watch
+    {
+        // Budget, set before adding
+        std::string s_Name;
+        MRH_Uint64 u64_SoftLimitNS; // Stack sample, 0 to disable
+        MRH_Uint64 u64_HardLimitNS; // Abort, 0 to disable
+        
+        // Running callback, the start is 0 while idle
+        std::atomic<MRH_Uint64> u64_StartNS;
+        std::atomic<int> i_Callback;
+        std::atomic<pthread_t> c_Thread;
+        
+        // Watchdog thread only
+        MRH_Uint64 u64_SampledNS; // Start of the last sampled call
+        MRH_Uint64 u64_AbortNS; // Time the abort was sent
+    };
+    
+    //*************************************************************************************
+    // Singleton
+    //*************************************************************************************
+    
+    /**
+     *  Get the class instance. This function is thread safe.
+     *
+     *  \return The class instance.
+     */
+    
+    static Watchdog& Singleton() noexcept;
+    
+    //*************************************************************************************
+    // Watch
+    //*************************************************************************************
+    
+    /**
+     *  Initialize a watch. Watches have to be initialized once before use.
+     *
+     *  \param c_Watch The watch to initialize.
+     *  \param s_Name The name used in the log.
+     *  \param u32_SoftLimitMS The callback time before a stack sample is taken, 
+     *                         0 to disable.
+     *  \param u32_HardLimitMS The callback time before the process is aborted, 0 
+     *                         to disable.
+     */
+    
+    static void InitWatch(Watch& c_Watch, std::string const& s_Name, MRH_Uint32 u32_SoftLimitMS, MRH_Uint32 u32_HardLimitMS) noexcept;
+    
+    /**
+     *  Start watching the callbacks of a watch. The watchdog thread is started 
+     *  with the first watch. Watches without limits are ignored.
+     *
+     *  \param p_Watch The watch to add. The watch has to stay valid until removed.
+     */
+    
+    void Add(Watch* p_Watch);
+    
+    /**
+     *  Stop watching the callbacks of a watch.
+     *
+     *  \param p_Watch The watch to remove.
+     */
+    
+    void Remove(Watch* p_Watch) noexcept;
+    
+    //*************************************************************************************
+    // Callback
+    //*************************************************************************************
+    
+    /**
+     *  Mark the start of a service callback on the calling thread.
+     *
+     *  \param c_Watch The watch of the service.
+     *  \param e_Callback The callback called.
+     */
+    
+    static void Enter(Watch& c_Watch, Callback e_Callback) noexcept;
+    
+    /**
+     *  Mark the end of a service callback.
+     *
+     *  \param c_Watch The watch of the service.
+     */
+    
+    static void Leave(Watch& c_Watch) noexcept;
+    
+    //*************************************************************************************
+    // Getters
+    //*************************************************************************************
+    
+    /**
+     *  Get the name of a service callback.
+     *
+     *  \param e_Callback The callback.
+     *
+     *  \return The service function name.
+     */
+    
+    static const char* GetCallbackName(Callback e_Callback) noexcept;
+
+private:
+
+    //*************************************************************************************
+    // Constructor / Destructor
+    //*************************************************************************************
+    
+    /**
+     *  Default constructor.
+     */
+    
+    Watchdog() noexcept;
+    
+    /**
+     *  Default destructor. The watchdog thread is stopped.
+     */
+    
+    ~Watchdog() noexcept;
+    
+    //*************************************************************************************
+    // Run
+    //*************************************************************************************
+    
+    /**
+     *  Watchdog thread function.
+     *
+     *  \param p_Instance The watchdog instance to run.
+     */
+    
+    static void Run(Watchdog* p_Instance) noexcept;
+    
+    /**
+     *  Check all watches for callbacks over their limits. The watchdog mutex has 
+     *  to be locked.
+     *
+     *  \param u64_NowNS The current monotonic clock time in nanoseconds.
+     */
+    
+    void Check(MRH_Uint64 u64_NowNS) noexcept;
+    
+    //*************************************************************************************
+    // Data
+    //*************************************************************************************
+    
+    // Watches
+    std::vector<Watch*> v_Watch;
+    MRH_Uint64 u64_IntervalNS;
+    
+    // Thread
+    std::thread c_Thread;
+    std::mutex c_Mutex;
+    std::condition_variable c_Condition;
+    bool b_Run;
+
+protected:
+
+};
+
+#endif /* Watchdog_h */